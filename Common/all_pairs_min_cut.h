@@ -0,0 +1,3357 @@
+/*all_pairs_min_cut.h holds everything that Random, GFamilly and Bonus share: the graph types, the knobs of the build and its modes, the seperator tree
+and its engines, and run_all_pairs, which does the whole run once a program has made its graph. A program defines COST_GEN_RANGE, RANDOM_SEED and
+PRINT_RESULTS, includes this file, defines the size of its graph and then only makes the graph in main. Every knob is only defined if it is not defined yet,
+so it can also be set on the command line of the compiler (make CFLAGS="-std=c++0x -O3 -DTRACE=1"). Every function that is not a template is inline, so more
+than one translation unit of a program may include this file*/
+#ifndef ALL_PAIRS_MIN_CUT_H
+#define ALL_PAIRS_MIN_CUT_H
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/random.hpp>
+#include <boost/graph/stoer_wagner_min_cut.hpp>
+#include <boost/graph/one_bit_color_map.hpp>
+#include <boost/graph/connected_components.hpp>
+#include <boost/graph/push_relabel_max_flow.hpp>
+#include <boost/graph/cuthill_mckee_ordering.hpp>
+#include <vector>
+#include <set>
+#include <map>
+#include <list>
+#include <climits>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <deque>
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <sched.h>
+
+using namespace boost;
+using namespace std;
+using namespace std::chrono;
+
+
+#ifndef OUTPUT_FORMAT
+#define OUTPUT_FORMAT FORMAT_TEXT /*format of the printed results: FORMAT_TEXT, FORMAT_CSV, FORMAT_JSONL or FORMAT_BINARY*/
+#endif
+#ifndef OUTPUT_FILE
+#define OUTPUT_FILE "" /*file the results are written to. If empty they are written to the standard output*/
+#endif
+#ifndef OUTPUT_COMPRESS
+#define OUTPUT_COMPRESS 0 /*if 1 the results are gzip compressed (needs zlib, build with make LIBS="-pthread -lz")*/
+#endif
+#ifndef OUTPUT_BUFFER_SIZE
+#define OUTPUT_BUFFER_SIZE (1 << 20) /*size in bytes of each of the two output buffers*/
+#endif
+#ifndef TREE_DELTA_ENCODE
+#define TREE_DELTA_ENCODE 0 /*if 1 the parents of the finished seperator tree are stored delta encoded*/
+#endif
+#ifndef SERVER_MODE
+#define SERVER_MODE 0 /*if 1 the program keeps running after the build and answers pair queries on SERVER_SOCKET*/
+#endif
+#ifndef SERVER_SOCKET
+#define SERVER_SOCKET "/tmp/all_pairs_min_cut.sock" /*path of the unix domain socket of the query server*/
+#endif
+#ifndef SERVER_THREADS
+#define SERVER_THREADS 4 /*number of reader threads of the query server*/
+#endif
+#ifndef APPROX_EPSILON
+#define APPROX_EPSILON 0.0 /*epsilon of the approximate mode. 0 builds the exact tree. The first command line argument overrides it*/
+#endif
+#ifndef APPROX_SAMPLING
+#define APPROX_SAMPLING 3.0 /*constant of the sampling probability of the approximate mode*/
+#endif
+#ifndef APPROX_CHECKS
+#define APPROX_CHECKS 20 /*number of tree edges that are compared with G to report the error of the approximate mode*/
+#endif
+#ifndef GLOBAL_CUT_ONLY
+#define GLOBAL_CUT_ONLY 0 /*if 1 only the global minimum cut is computed (with GLOBAL_CUT_METHOD) instead of the whole seperator tree*/
+#endif
+#ifndef GLOBAL_CUT_METHOD
+#define GLOBAL_CUT_METHOD GLOBAL_NAGAMOCHI_IBARAKI /*GLOBAL_NAGAMOCHI_IBARAKI (contractions of the edges that a scan proves heavy) or GLOBAL_STOER_WAGNER (the boost library, much slower)*/
+#endif
+#ifndef CUT_CACHE_BYTES
+#define CUT_CACHE_BYTES (64 << 20) /*memory budget in bytes of the cache of minimum cut results. 0 disables the cache*/
+#endif
+#ifndef PRINT_CLUSTERS
+#define PRINT_CLUSTERS 0 /*if 1 the nested clustering of the seperator tree (every merge of two clusters and its minimum cut) is printed*/
+#endif
+#ifndef CLUSTER_THRESHOLD
+#define CLUSTER_THRESHOLD 0 /*if > 0 the groups of nodes whose pairs all have a minimum cut of at least CLUSTER_THRESHOLD are printed*/
+#endif
+#ifndef PRINT_WITNESSES
+#define PRINT_WITNESSES 0 /*if > 0 the side of the minimum cut of this many random pairs is printed (every node that stays with the first node of the pair)*/
+#endif
+#define ENGINE_HEURISTIC 0
+#define ENGINE_GUSFIELD 1
+#ifndef CUT_ENGINE
+#define CUT_ENGINE ENGINE_HEURISTIC /*ENGINE_HEURISTIC builds the tree with locate and minimum_cut. ENGINE_GUSFIELD builds a flow equivalent tree with Gusfield's method and exact maximum flows*/
+#endif
+#ifndef DIRECTED_GRAPH
+#define DIRECTED_GRAPH 0 /*if 1 every edge is an arc from the node it was added from to the other node (only with ENGINE_GUSFIELD)*/
+#endif
+#ifndef VERTEX_CAPACITIES
+#define VERTEX_CAPACITIES 0 /*if 1 every node gets a random capacity that also limits the flow through it (only with ENGINE_GUSFIELD)*/
+#endif
+#ifndef REORDER_VERTICES
+#define REORDER_VERTICES 0 /*if 1 the tree is built on a copy of G whose nodes are renumbered in reverse Cuthill-McKee order for locality. The nodes are still processed in the order of G, so only the memory layout changes (heuristic engine only)*/
+#endif
+#ifndef BUILD_WORKERS
+#define BUILD_WORKERS 0 /*if > 0 the cuts of ENGINE_GUSFIELD are computed by this many worker processes (see build_distributed)*/
+#endif
+#ifndef NUMA_PLACEMENT
+#define NUMA_PLACEMENT 0 /*if 1 the build workers are spread over the NUMA nodes and pinned to the cpus of their node, so the flow network each one builds stays in its local memory*/
+#endif
+#ifndef OUT_OF_CORE
+#define OUT_OF_CORE 0 /*if 1 the generator writes the adjacency lists straight to shards on disk instead of building G, and only OUT_OF_CORE_BUDGET bytes of them are kept in memory during the build*/
+#endif
+#ifndef OUT_OF_CORE_DIR
+#define OUT_OF_CORE_DIR "/tmp/all_pairs_min_cut.shards" /*directory of the shard files of the out of core mode*/
+#endif
+#ifndef OUT_OF_CORE_SHARD_NODES
+#define OUT_OF_CORE_SHARD_NODES 4096 /*number of nodes per shard*/
+#endif
+#ifndef OUT_OF_CORE_BUDGET
+#define OUT_OF_CORE_BUDGET (16 << 20) /*memory budget in bytes of the shards that are loaded at the same time*/
+#endif
+#ifndef STREAM_MODE
+#define STREAM_MODE 0 /*if 1 the program reads edge updates after the build and keeps the tree up to date in batches (see stream_updates). With SERVER_MODE the queries are answered from each new tree while the stream runs*/
+#endif
+#ifndef STREAM_INPUT
+#define STREAM_INPUT "" /*file the edge updates are read from. If empty they are read from the standard input*/
+#endif
+#ifndef STREAM_WINDOW_MS
+#define STREAM_WINDOW_MS 100 /*a batch holds the updates that arrive within this many milliseconds of its first one*/
+#endif
+#ifndef STREAM_MAX_DRIFT
+#define STREAM_MAX_DRIFT 0.1 /*share of the edges that may change before the tree is rebuilt instead of repaired*/
+#endif
+#ifndef DIFF_HARNESS
+#define DIFF_HARNESS 0 /*if 1 the program only builds the tree of its graph with every engine, compares them and appends the results to DIFF_REPORT*/
+#endif
+#ifndef DIFF_REPORT
+#define DIFF_REPORT "diff_report.txt" /*file the differential harness appends its results to*/
+#endif
+#ifndef DIFF_ALL_PAIRS
+#define DIFF_ALL_PAIRS 1500 /*graphs with up to this many nodes are compared on all pairs*/
+#endif
+#ifndef DIFF_SAMPLES
+#define DIFF_SAMPLES 200000 /*number of random pairs that larger graphs are compared on*/
+#endif
+#ifndef DIFF_FLOW_PAIRS
+#define DIFF_FLOW_PAIRS 2000 /*number of the compared pairs whose value in every engine is checked against a maximum flow of the pair in G*/
+#endif
+#ifndef THRESHOLD_QUERIES
+#define THRESHOLD_QUERIES 0 /*if > 0 this many random pairs are asked whether their minimum cut is at least THRESHOLD_K while the tree is built. A pair is answered from the tree once it proves the answer and with a flow that stops at THRESHOLD_K units before (see threshold_reader)*/
+#endif
+#ifndef THRESHOLD_K
+#define THRESHOLD_K 4 /*capacity that the threshold queries ask for*/
+#endif
+#ifndef THRESHOLD_CHECK
+#define THRESHOLD_CHECK 0 /*if 1 every threshold answer is checked against the full flow of the pair, which costs more than the bounded flows save*/
+#endif
+#ifndef TRACE
+#define TRACE 0 /*if 1 graph generation, the build, every locate and minimum_cut call and the output are timed, written to TRACE_FILE and summed up per phase*/
+#endif
+#ifndef TRACE_FILE
+#define TRACE_FILE "trace.json" /*file the trace is written to*/
+#endif
+#ifndef TRACE_FORMAT
+#define TRACE_FORMAT TRACE_CHROME /*TRACE_CHROME writes Chrome trace event JSON (chrome://tracing or Perfetto), TRACE_FOLDED folded stacks for flamegraph.pl*/
+#endif
+#ifndef LIVE_READERS
+#define LIVE_READERS 0 /*if > 0 this many threads query random settled pairs while the tree is built, and their answers are checked against the finished tree*/
+#endif
+
+#if OUTPUT_COMPRESS
+#include <zlib.h>
+#endif
+
+struct EdgeProperty {
+	int value;
+};
+
+struct VertexProperty {
+	int capacity; /*how much flow may pass through the node. 0 means no limit*/
+};
+
+typedef adjacency_list<vecS, vecS, undirectedS, VertexProperty, EdgeProperty> Graph;
+typedef graph_traits<Graph>::edge_parallel_category disallow_parallel_edge_tag;
+typedef graph_traits<Graph>::vertex_descriptor vertex_d;
+typedef graph_traits<Graph>::edge_descriptor edge_d;
+typedef graph_traits<Graph>::vertex_iterator vertex_t;
+typedef graph_traits<Graph>::edge_iterator edge_t;
+typedef graph_traits<Graph>::out_edge_iterator out_edge_t;
+
+typedef property_map<Graph, int EdgeProperty::*>::type edge_property_map;
+
+/*cut_cache remembers the result of minimum_cut for a (s, t) pair, so that the cuts that locate asks for again and again are computed only once. It is bounded by
+a byte budget and evicts the least recently used pair when the budget is exceeded. The cached results are only valid for the capacities they were computed with,
+so whoever changes capacities has to call invalidate*/
+class cut_cache {
+public:
+	cut_cache(size_t max_bytes = CUT_CACHE_BYTES);
+	const pair<vector<vertex_d>, int>* lookup(vertex_d s, vertex_d t); /*NULL if the pair is not cached*/
+	void insert(vertex_d s, vertex_d t, const pair<vector<vertex_d>, int>& cut);
+	void invalidate();
+	size_t hits() const { return n_hits; }
+	size_t misses() const { return n_misses; }
+	size_t bytes() const { return used_bytes; }
+private:
+	struct entry {
+		vertex_d s, t;
+		pair<vector<vertex_d>, int> cut;
+	};
+	size_t entry_bytes(const entry& e) const;
+
+	size_t max_bytes, used_bytes;
+	size_t n_hits, n_misses;
+	list<entry> lru; /*most recently used pair first*/
+	map<pair<vertex_d, vertex_d>, list<entry>::iterator> index;
+};
+
+class live_tree;
+
+/*cut_context holds the scratch state of a minimum_cut call (the predecessor and visited maps). Keeping it outside of the graph means the graph is only read,
+so many cuts (one context each) can run on the same graph at the same time*/
+struct cut_context {
+	vector<vertex_d> pred; /*predecessor map*/
+	vector<int> visited; /*visited map. A node counts as visited only if its entry equals stamp, so the map is kept between searches and calls instead of being cleared*/
+	int stamp; /*stamp of the current search*/
+	cut_cache* cache; /*if set, minimum_cut answers repeated pairs from this cache*/
+	live_tree* live; /*if set, build_tree publishes every node it attaches here for concurrent readers*/
+
+	cut_context(size_t n = 0, cut_cache* cache = NULL) : pred(n), visited(n), stamp(0), cache(cache), live(NULL) {}
+	/*starts a new search: every node becomes "not visited" at once. The map is only cleared when the stamps run out*/
+	int new_search() {
+		if (stamp == INT_MAX) {
+			fill(visited.begin(), visited.end(), 0);
+			stamp = 0;
+		}
+		return ++stamp;
+	}
+};
+
+/*The algorithms that global_minimum_cut can use*/
+enum global_cut_method { GLOBAL_STOER_WAGNER, GLOBAL_NAGAMOCHI_IBARAKI };
+
+/*an edge of the contracted graphs of global_minimum_cut*/
+struct contracted_edge {
+	int u, v;
+	long long w;
+};
+
+/*an edge update of the stream mode*/
+struct stream_update {
+	char op; /*'+' inserts the edge u-v (or sets its capacity if it exists), '-' deletes it and '=' changes its capacity*/
+	vertex_d u, v;
+	int value;
+	high_resolution_clock::time_point arrived; /*when the update was read, for the latency of its batch*/
+};
+
+/*The formats in which result_writer can emit the seperator tree and the pair results*/
+enum output_format { FORMAT_TEXT, FORMAT_CSV, FORMAT_JSONL, FORMAT_BINARY };
+
+/*The formats of the trace of the TRACE mode*/
+enum trace_format { TRACE_CHROME, TRACE_FOLDED };
+
+/*result_writer formats the results into a large buffer and hands full buffers to a background thread that writes them to the file (double buffering), so that
+printing overlaps with computing instead of flushing on every line. Node ids are written 1-based like the rest of the output. In FORMAT_BINARY every record is
+1 byte kind (0 = tree edge, 1 = pair, 2 = cluster merge, 3 = group, 4 = cut side) followed by three little endian 32 bit integers u, v and value, the same fields as the other formats (a cut side record has the node of the side as its value)*/
+class result_writer {
+public:
+	result_writer(output_format format, const char* path, bool compress, size_t buffer_size = OUTPUT_BUFFER_SIZE);
+	~result_writer();
+	void message(const char* text); /*a free text line, only written in FORMAT_TEXT*/
+	void tree_edge(vertex_d u, vertex_d v, int value); /*an edge of the seperator tree*/
+	void pair_value(vertex_d i, vertex_d j, int value); /*the minimum cut value of a pair of nodes*/
+	void cluster_merge(size_t a, size_t b, int value); /*two clusters of the hierarchy that join at a minimum cut of value*/
+	void group(vertex_d v, vertex_d g, int k); /*node v is in the group named after node g at threshold k*/
+	void side(vertex_d i, vertex_d j, vertex_d v); /*node v is on the side of i in the minimum cut of i and j*/
+	void close(); /*write everything that is still buffered and stop the background thread*/
+private:
+	void record(int kind, vertex_d u, vertex_d v, int value);
+	void put(const char* data, size_t len);
+	void put_int(long long x);
+	void hand_over(); /*pass the front buffer to the background thread*/
+	void run(); /*body of the background thread*/
+
+	output_format format;
+	bool compress;
+	size_t buffer_size;
+	FILE* out;
+	void* gz; /*gzFile when compress is set*/
+	string front, back; /*front is filled by the computing thread while back is being written by the background thread*/
+	bool pending, done, closed;
+	mutex m;
+	condition_variable cv;
+	thread worker;
+};
+
+/*jump_tree is a tree that only grows by new leaves, with the jump pointers of Myers: every node keeps one ancestor further up, chosen so that any climb takes
+O(log N) jumps (the skew binary jumps), and the lower node of the lightest edge on the way to it. A new leaf gets its jump from the jumps of its parent in O(1),
+and the lightest edge on a path and whether a node lies in the subtree of another take O(log N) whatever the depth of the tree, in O(N) space where binary
+lifting would keep log N ancestors per node. The seperator tree only ever gains leaves, so this is all the dynamic tree it needs: a link-cut tree would pay
+O(log N) amortized splay work for every link to support cuts that never happen*/
+class jump_tree {
+public:
+	jump_tree(size_t n = 0); /*n nodes that are all roots until they are linked*/
+	void link(vertex_d child, vertex_d parent, int value); /*child becomes a leaf below parent through an edge of this value. child must not have a parent yet*/
+	vertex_d parent(vertex_d v) const { return up[v]; }
+	vertex_d lightest(vertex_d u, vertex_d v) const; /*the lower node of the lightest edge on the path between u and v. u and v must differ and be in one tree*/
+	int path_min(vertex_d u, vertex_d v) const; /*value of that edge, INT_MAX if u == v*/
+	bool below(vertex_d x, vertex_d w) const; /*true if x is w or in the subtree of w*/
+private:
+	vertex_d lighter(vertex_d a, vertex_d b) const { return (weight[b] < weight[a]) ? b : a; }
+
+	vector<vertex_d> up, depth;
+	vector<int> weight; /*value of the edge from every node to its parent*/
+	vector<vertex_d> jump, low; /*jump[v] is the ancestor v jumps to and low[v] the lower node of the lightest edge from v up to it*/
+};
+
+/*tree_edge_index is kept next to the seperator tree while it is built. It keeps the tree edges ordered by value, which replaces the scan over all tree edges
+in locate, the number of tree edges of every node, and the tree itself as a jump_tree for path minimum and subtree queries in O(log N)*/
+class tree_edge_index {
+public:
+	tree_edge_index(size_t n = 0);
+	void link(vertex_d child, vertex_d parent, int value); /*adds the tree edge child-parent*/
+	int degree(vertex_d v) const { return deg[v]; } /*number of tree edges at v*/
+	size_t edges() const { return added.size(); } /*number of tree edges so far*/
+	bool lightest_edge(int threshold, vertex_d a, vertex_d b, vertex_d& u, vertex_d& v, int& value); /*the smallest edge with value >= threshold other than a-b. Ties go to the edge added first*/
+	int path_min(vertex_d u, vertex_d v) const { return paths.path_min(u, v); } /*smallest tree edge between two nodes of the tree, INT_MAX if u == v*/
+	bool on_side(vertex_d x, vertex_d a, vertex_d b) const; /*true if x stays with a when the tree edge a-b is removed*/
+private:
+	jump_tree paths;
+	vector<int> deg; /*number of tree edges of every node*/
+	vector<pair<vertex_d, vertex_d>> added; /*tree edges in the order they were added*/
+	set<pair<int, size_t>> by_value; /*(value, position in added) of every tree edge*/
+};
+
+/*packed_array stores unsigned integers with the smallest byte width (1, 2, 4 or 8) that holds every value stored so far. It widens itself when a larger value arrives*/
+class packed_array {
+public:
+	packed_array(size_t n = 0, unsigned long long max_value = 0);
+	unsigned long long get(size_t i) const;
+	void set(size_t i, unsigned long long x);
+	size_t size() const { return n; }
+	int width() const { return bytes_per_value; }
+	size_t bytes() const { return data.capacity(); }
+	void release(); /*drop the contents*/
+private:
+	static int width_for(unsigned long long x);
+	size_t n;
+	int bytes_per_value;
+	vector<unsigned char> data;
+};
+
+/*compact_tree is the seperator tree as it is kept after the build: for every node the node it was attached to (its parent) and the value of that edge, which is the
+minimum cut between the two. Node 0 is the root and is its own parent. Both arrays are packed_arrays, so a tree with a few hundred million nodes takes a few hundred MB.
+After encode_deltas the parents are kept as variable length differences node - parent, which are small because every node is attached to a node added before it*/
+class compact_tree {
+public:
+	compact_tree(size_t n = 0);
+	void attach(vertex_d v, vertex_d parent, int value);
+	vertex_d parent(vertex_d v) const;
+	int value(vertex_d v) const { return (int)values.get(v); }
+	size_t size() const { return n; }
+	size_t bytes() const;
+	int path_min(vertex_d u, vertex_d v) const; /*smallest edge on the path between u and v (INT_MAX if u == v)*/
+	vertex_d path_min_node(vertex_d u, vertex_d v) const; /*the lower node of that edge. Its subtree is one side of the minimum cut of u and v*/
+	void encode_deltas(); /*re-store the parents delta encoded. attach can not be used afterwards*/
+private:
+	size_t n;
+	packed_array parents, values;
+	vector<unsigned char> deltas; /*zigzag varint of node - parent for every node, when delta encoded*/
+	vector<size_t> delta_index; /*offset in deltas of every DELTA_BLOCK-th node*/
+	static const size_t DELTA_BLOCK = 32;
+};
+
+/*cut_hierarchy is the nested clustering that a seperator tree describes. Two nodes have a minimum cut of at least k exactly when every edge on their tree path
+is at least k, so merging the ends of the tree edges from the largest value down (with union-find) joins the groups of every threshold in order.
+The edges are sorted once and every merge is kept, so the whole hierarchy costs O(N log N) and the partition at a threshold O(N)*/
+class cut_hierarchy {
+public:
+	struct merge {
+		int value; /*minimum cut at which the two clusters join*/
+		vertex_d u, v; /*the tree edge that joins them*/
+		size_t left, right; /*the clusters that join. Ids below the number of nodes are single nodes and id N + m is the cluster made by merge m*/
+	};
+	cut_hierarchy(const compact_tree& tree);
+	size_t size() const { return n; }
+	const vector<merge>& merges() const { return steps; } /*by decreasing value*/
+	vector<vertex_d> partition(int k) const; /*the group of every node when every pair of a group needs a minimum cut of at least k. A group is named after its smallest node*/
+private:
+	size_t n;
+	vector<merge> steps;
+};
+
+/*cut_witness answers which nodes are on each side of the minimum cut of a pair without keeping any cut set. The nodes are stored once in the preorder of the
+seperator tree, where every subtree is a contiguous range, and the lightest edge on a path is found with a jump_tree, so it is O(N) space in all. A side is
+returned as spans into the preorder, so a query takes O(log N) plus whatever the caller reads of the side.
+The side is the subtree below the lightest edge, the same one that path_min_node gives. It always seperates the pair, but the trees are only flow equivalent,
+so the capacity of the edges that leave it in G can be larger than the minimum cut*/
+class cut_witness {
+public:
+	struct span { /*a range of the preorder that is read in place*/
+		const vertex_d* first;
+		const vertex_d* last;
+		const vertex_d* begin() const { return first; }
+		const vertex_d* end() const { return last; }
+		size_t size() const { return last - first; }
+	};
+	cut_witness(const compact_tree& tree);
+	vertex_d lightest(vertex_d u, vertex_d v) const { return paths.lightest(u, v); } /*the lower node of the lightest edge on the path between u and v. u and v must differ*/
+	pair<span, span> side(vertex_d u, vertex_d v) const; /*the nodes that stay with u in the minimum cut of u and v, as at most two spans (the second may be empty)*/
+private:
+	size_t n;
+	vector<vertex_d> order, pos, subtree; /*preorder, place of every node in it and size of every subtree*/
+	jump_tree paths;
+};
+
+/*live_tree publishes the seperator tree while build_tree grows it, so that reader threads can answer pairs that are already settled without waiting for the
+build. Node i is settled once it is attached, and since later nodes only hang below settled ones the path between two settled nodes never changes again.
+The builder writes the parent and value of a node and then moves the frontier forward with a release store. A reader loads the frontier with an acquire load
+and only walks nodes below it, so it sees a consistent tree without locks and the builder never waits for readers.
+The heuristic engine and Gusfield's method (gusfield_cuts and build_distributed) settle nodes one by one. The values of Gusfield's method are exact once settled,
+and it also anchors every node that is not settled yet to the settled node it hangs below. A cut only moves the nodes on its side under the new node, which hangs
+below their old anchor, so the final path of a node enters the settled nodes at every anchor it ever had, and the path between the anchors of two nodes is an
+upper bound on their minimum cut: a cut side bounds every pair it separates before the tree is finished*/
+class live_tree {
+public:
+	live_tree(size_t n);
+	void reset(); /*builder: a new build starts and only node 0 is settled. Must not run while readers are active*/
+	void reset(bool exact); /*the same, for a builder whose values are exact and that anchors the nodes that are not settled*/
+	void settle(vertex_d v, vertex_d parent, int value); /*builder: attach v, which has to be the node right after the frontier*/
+	void anchor(vertex_d v, vertex_d node); /*builder: v, which is not settled, hangs below the settled node*/
+	size_t settled() const { return frontier.load(std::memory_order_acquire); } /*number of settled nodes (nodes 0 to settled() - 1)*/
+	int path_min(vertex_d u, vertex_d v) const; /*minimum cut of u and v, or -1 if one of them is not settled yet*/
+	int upper_bound(vertex_d u, vertex_d v) const; /*a proven upper bound on the minimum cut of u and v from their anchors, INT_MAX if there is none yet*/
+	int at_least(vertex_d u, vertex_d v, int k) const; /*1 if the minimum cut of u and v is proven to be at least k, 0 if it is proven to be below k, -1 if neither is proven yet*/
+	size_t size() const { return n; }
+private:
+	size_t n;
+	vector<std::atomic<vertex_d> > parents; /*the parent of a settled node and the anchor of the others*/
+	vector<std::atomic<int> > values;
+	std::atomic<size_t> frontier;
+	std::atomic<bool> exact;
+};
+
+/*trace_log collects the timed scopes of the run when TRACE is set. Every scope becomes one event with its start, duration, self time (the part not spent in
+the scopes inside it) and depth, in a buffer of its thread, so closing a scope takes no lock and builds no string. A thread closes the scopes inside a scope
+before the scope itself, so the call stack of every event is rebuilt from the depths when the trace is written. write turns the events into Chrome trace events
+(one complete event per scope, with the node it worked on) or into folded stacks (the self time of every call stack, for flamegraph.pl), and summary prints the
+calls and time of every phase. Both are called once the traced threads are done*/
+class trace_log {
+public:
+	struct event {
+		const char* name;
+		long long arg; /*node the scope works on, -1 if none*/
+		long long start, duration, self; /*microseconds since the log was created*/
+		int depth; /*number of open scopes of the same thread around this one*/
+	};
+	static trace_log& get();
+	long long now() const; /*microseconds since the log was created*/
+	void add(const event& e); /*appends e to the buffer of the calling thread*/
+	void write(const char* path, trace_format format) const;
+	void summary() const;
+private:
+	struct thread_events {
+		int tid; /*small id of the thread, given in the order in which threads first trace something*/
+		vector<event> events; /*in the order in which the scopes were closed*/
+	};
+	trace_log();
+	thread_events& local(); /*the buffer of the calling thread, made on its first event*/
+	high_resolution_clock::time_point origin;
+	mutable mutex m; /*guards threads, which only changes when a thread traces its first event*/
+	deque<thread_events> threads; /*a deque keeps the buffers in place while others are added*/
+};
+
+/*scoped_timer times the block it is declared in (or up to end) as a scope of trace_log. Scopes of one thread nest like the blocks, so every timer knows the one
+around it. What a timer spends on itself is neither in its own scope nor in the self time of the scope around it. Without TRACE it is empty and costs nothing*/
+class scoped_timer {
+public:
+#if TRACE
+	scoped_timer(const char* name, long long arg = -1);
+	~scoped_timer() { end(); }
+	void end(); /*closes the scope before the end of the block*/
+private:
+	const char* name;
+	long long arg, start, children; /*children is the time spent in the scopes inside this one*/
+	bool open;
+	scoped_timer* outer;
+	int depth;
+	static scoped_timer*& innermost() { static thread_local scoped_timer* last = NULL; return last; } /*the open scope of this thread that was opened last*/
+#else
+	scoped_timer(const char*, long long = -1) {}
+	void end() {}
+#endif
+};
+
+/*query_server keeps the seperator tree loaded and answers batches of pair queries over a unix domain socket. Every request is a uint32 count followed by count
+records of three uint32 (op, i, j) and is answered with a uint32 count followed by count int32 results. Node ids are 1-based like the rest of the output.
+op 0 asks for the minimum cut of i and j and op 1 for the side of that cut: the node whose subtree in the seperator tree is cut off from the rest.
+Only the event loop thread touches the sockets, which are non-blocking. It keeps the bytes of every connection until they make a whole request, hands whole
+requests to a pool of reader threads and writes the responses they give back, so a client that sends half a request or stops reading only holds up itself.
+A connection has at most one request with the readers at a time, so its responses come in the order of its requests. The tree is held through a shared_ptr
+that is swapped atomically when a rebuild finishes, so queries in flight keep the tree they started with and never wait for the rebuild*/
+class query_server {
+public:
+	enum { OP_MIN_CUT = 0, OP_CUT_SIDE = 1 };
+	query_server(const char* path, int threads = SERVER_THREADS);
+	~query_server();
+	void publish(std::shared_ptr<const compact_tree> tree); /*make a new tree visible to all following queries*/
+	void start(); /*start answering queries in the background, for instance while the stream mode updates the tree. serve starts them if this was not called*/
+	void serve(std::function<std::shared_ptr<const compact_tree>()> rebuild); /*run until SIGINT or SIGTERM. SIGHUP calls rebuild and publishes its result*/
+private:
+	struct connection {
+		uint64_t serial; /*tells the connection apart from a later one that gets the same fd*/
+		vector<char> in, out; /*bytes read that do not make a whole request yet and bytes of responses not written yet*/
+		bool busy; /*a request of this connection is with the readers*/
+	};
+	struct batch {
+		int fd;
+		uint64_t serial;
+		vector<uint32_t> request; /*the (op, i, j) records*/
+		vector<int32_t> response; /*count and results, filled in by a reader*/
+	};
+	void event_loop();
+	void reader();
+	void answer(batch& b); /*answer the request of b from the current tree*/
+	bool receive(int fd, connection& c); /*read what fd has. false if the connection is closed or sent a bad request*/
+	bool send(int fd, connection& c); /*write what fd takes. false if the connection is closed*/
+	void dispatch(int fd, connection& c); /*hand the next whole request of c to the readers*/
+	void watch(int fd, const connection& c); /*wait for what c needs next: more requests, or room for its responses*/
+
+	string path;
+	int n_threads;
+	int listen_fd, epoll_fd, wake_fd; /*wake_fd tells the event loop that responses are done*/
+	std::shared_ptr<const compact_tree> current;
+	map<int, connection> connections; /*only used by the event loop*/
+	uint64_t next_serial;
+	deque<batch> ready, done; /*requests waiting for a reader and responses waiting for the event loop*/
+	mutex m;
+	condition_variable cv;
+	atomic<bool> stopping;
+	vector<thread> threads; /*the readers and the event loop*/
+};
+
+/*shard_writer writes the shards of a shard_graph straight from the generator of a program, so that the graph never has to be built in memory. The nodes are
+split in shards of shard_nodes consecutive nodes. Every edge goes to the bucket of the shard of each of its ends, a bucket is kept in memory until the
+buckets hold budget bytes and is then appended to its file. The shard_graph that is made from the writer turns every bucket into the CSR file of its shard,
+one shard at a time*/
+class shard_writer {
+public:
+	shard_writer(size_t n, const string& dir, size_t shard_nodes = OUT_OF_CORE_SHARD_NODES, size_t budget = OUT_OF_CORE_BUDGET);
+	void add_edge(vertex_d u, vertex_d v, int value); /*an undirected edge. Every node keeps its edges in the order they are added, like a Graph does*/
+	size_t size() const { return n; }
+	size_t edges() const { return n_edges; }
+private:
+	friend class shard_graph;
+	void finish(); /*writes the shard files. No edge can be added after it*/
+	struct record {
+		uint32_t source, target;
+		int32_t value;
+	};
+	string bucket(size_t k) const;
+	void flush(); /*appends every bucket in memory to its file*/
+
+	string dir;
+	size_t n, shard_nodes, budget, n_edges, buffered;
+	vector<vector<record> > buckets;
+};
+
+/*shard_graph is a read only graph whose adjacency lists live on disk instead of in memory, in the shards that a shard_writer wrote. Every shard is one file
+in CSR form (an offset per node and a (target, capacity) entry per out edge). Shards are read on demand into a buffer pool that keeps at most budget bytes
+of them and drops the least recently used shard when it is full. A shard that is still in use by an iterator stays alive until the iterator is gone, even
+if the pool has dropped it. While a session is open (minimum_cut opens one for every call) the shards that its thread asks for are held by the session and
+found again without the lock of the pool, so a cut reads each shard it touches at most once. It offers the same graph functions that minimum_cut and locate
+use on a Graph (see the free functions below), so the build runs on it unchanged*/
+class shard_graph {
+public:
+	struct adj_entry {
+		uint32_t target;
+		int32_t value;
+	};
+	struct shard {
+		vector<uint64_t> offsets; /*out edges of node first + i are entries[offsets[i]] .. entries[offsets[i + 1] - 1]*/
+		vector<adj_entry> entries;
+	};
+	struct edge_desc {
+		vertex_d source, target;
+		int value;
+	};
+	class out_edge_iterator {
+	public:
+		out_edge_iterator() : pos(NULL), src(0) {}
+		out_edge_iterator(std::shared_ptr<const shard> block, const adj_entry* pos, vertex_d src) : block(block), pos(pos), src(src) {}
+		edge_desc operator*() const {
+			edge_desc e = { src, pos->target, pos->value };
+			return e;
+		}
+		out_edge_iterator& operator++() { pos++; return *this; }
+		out_edge_iterator operator++(int) { out_edge_iterator old = *this; pos++; return old; }
+		bool operator==(const out_edge_iterator& o) const { return pos == o.pos; }
+		bool operator!=(const out_edge_iterator& o) const { return pos != o.pos; }
+	private:
+		std::shared_ptr<const shard> block; /*keeps the shard in memory while the iterator is used*/
+		const adj_entry* pos;
+		vertex_d src;
+	};
+	/*plays the role of edge_property_map: the capacity travels with the edge descriptor*/
+	struct value_map {
+		int operator[](const edge_desc& e) const { return e.value; }
+	};
+
+	/*holds the shards that its thread loads from G until it is closed*/
+	class session {
+	public:
+		session(const shard_graph& G);
+		~session();
+	private:
+		friend class shard_graph;
+		const shard_graph& G;
+		session* outer; /*the session that was open on this thread before*/
+		vector<pair<size_t, std::shared_ptr<const shard>>> held;
+	};
+
+	shard_graph(shard_writer& writer); /*finishes the shards of writer and opens them*/
+	~shard_graph(); /*removes the shard files*/
+	size_t size() const { return n; }
+	std::shared_ptr<const shard> load(vertex_d v) const; /*the shard of node v*/
+	vertex_d first(vertex_d v) const { return v - v % shard_nodes; } /*first node of the shard of v*/
+	size_t loads() const { return n_loads; }
+	size_t peak_bytes() const { return peak; }
+	size_t disk_bytes() const { return on_disk; }
+private:
+	string file(size_t k) const;
+	std::shared_ptr<const shard> fetch(size_t k) const; /*shard k from the pool, read from disk if it is not there*/
+
+	static session*& open() { static thread_local session* innermost = NULL; return innermost; } /*the innermost session of this thread*/
+	string dir;
+	size_t n, shard_nodes, budget, on_disk;
+	mutable mutex m;
+	mutable list<pair<size_t, std::shared_ptr<const shard>>> lru; /*most recently used shard first*/
+	mutable map<size_t, list<pair<size_t, std::shared_ptr<const shard>>>::iterator> resident;
+	mutable size_t used, peak, n_loads;
+};
+
+/*cut_session keeps what minimum_cut needs of G for the length of one call. A graph in memory needs nothing*/
+template <class GraphT>
+struct cut_session {
+	cut_session(const GraphT&) {}
+};
+template <>
+struct cut_session<shard_graph> : shard_graph::session {
+	cut_session(const shard_graph& G) : shard_graph::session(G) {}
+};
+
+/*the graph functions of shard_graph, with the same names and meaning as the Boost functions that minimum_cut and locate call on a Graph*/
+inline size_t num_vertices(const shard_graph& G) { return G.size(); }
+inline vertex_d source(const shard_graph::edge_desc& e, const shard_graph&) { return e.source; }
+inline vertex_d target(const shard_graph::edge_desc& e, const shard_graph&) { return e.target; }
+inline pair<shard_graph::out_edge_iterator, shard_graph::out_edge_iterator> out_edges(vertex_d v, const shard_graph& G) {
+	std::shared_ptr<const shard_graph::shard> block = G.load(v);
+	size_t i = v - G.first(v);
+	const shard_graph::adj_entry* base = block->entries.data();
+	return make_pair(shard_graph::out_edge_iterator(block, base + block->offsets[i], v), shard_graph::out_edge_iterator(block, base + block->offsets[i + 1], v));
+}
+inline size_t out_degree(vertex_d v, const shard_graph& G) {
+	std::shared_ptr<const shard_graph::shard> block = G.load(v);
+	size_t i = v - G.first(v);
+	return block->offsets[i + 1] - block->offsets[i];
+}
+inline pair<shard_graph::edge_desc, bool> edge(vertex_d u, vertex_d v, const shard_graph& G) {
+	shard_graph::out_edge_iterator ei, ei_end;
+	for (tie(ei, ei_end) = out_edges(u, G); ei != ei_end; ei++) {
+		if ((*ei).target == v) return make_pair(*ei, true);
+	}
+	shard_graph::edge_desc none = { u, v, 0 };
+	return make_pair(none, false);
+}
+
+namespace boost {
+	template <> struct graph_traits<shard_graph> {
+		typedef vertex_d vertex_descriptor;
+		typedef shard_graph::edge_desc edge_descriptor;
+		typedef shard_graph::out_edge_iterator out_edge_iterator;
+		typedef size_t vertices_size_type;
+		typedef size_t degree_size_type;
+	};
+}
+
+/*flow_network is the directed graph on which the exact engine runs its maximum flows. An undirected edge becomes the arcs u -> v and v -> u and a directed
+edge only u -> v, every arc with a reverse arc of capacity 0. If some node has a capacity every node v is split into v (where the arcs come in) and N + v
+(where they leave) joined by an arc of the node capacity, so that it limits all the flow that v sends, receives or passes on.
+The direction is a template tag, so the undirected network has no directed code in it and needs one flow per cut instead of two*/
+typedef adjacency_list_traits<vecS, vecS, directedS> flow_traits;
+typedef adjacency_list<vecS, vecS, directedS, no_property,
+	property<edge_capacity_t, long long, property<edge_residual_capacity_t, long long, property<edge_reverse_t, flow_traits::edge_descriptor>>>> FlowGraph;
+
+template <class DirectionTag>
+class flow_network {
+public:
+	flow_network(const Graph& G, const edge_property_map& val);
+	/*the minimum cut between s and t and a flag per node of G that is set for the nodes on the side of s. For a directed graph it is the smaller cut of
+	the two directions, which keeps the cut values symmetric so that they fit in a tree*/
+	pair<vector<char>, long long> cut(vertex_d s, vertex_d t);
+	/*true if every cut between s and t has a capacity of at least k. The flow stops as soon as it reaches k, so a pair far above k costs about k augmenting paths
+	instead of a whole maximum flow. If the answer is no, side flags the nodes on the side of s of a cut below k*/
+	bool at_least(vertex_d s, vertex_d t, long long k, vector<char>& side);
+private:
+	bool at_least(vertex_d s, vertex_d t, long long k, vector<char>& side, undirected_tag);
+	bool at_least(vertex_d s, vertex_d t, long long k, vector<char>& side, directed_tag);
+	long long bounded_flow(vertex_d s, vertex_d t, long long k, vector<char>& side); /*flow from s to t with shortest augmenting paths until k units. side as in flow if it stays below k*/
+	pair<vector<char>, long long> cut(vertex_d s, vertex_d t, undirected_tag);
+	pair<vector<char>, long long> cut(vertex_d s, vertex_d t, directed_tag);
+	void add_edge_arcs(vertex_d u, vertex_d v, long long c, undirected_tag);
+	void add_edge_arcs(vertex_d u, vertex_d v, long long c, directed_tag);
+	void add_arcs(vertex_d u, vertex_d v, long long forward, long long backward); /*u -> v and its reverse*/
+	long long flow(vertex_d s, vertex_d t, vector<char>& side); /*maximum flow from s to t. side is set for the nodes of G that s still reaches in the residual network*/
+	vertex_d in(vertex_d v) const { return v; }
+	vertex_d out(vertex_d v) const { return split ? n + v : v; }
+
+	size_t n;
+	bool split;
+	FlowGraph F;
+};
+
+
+/*what a program adds to the run that run_all_pairs does for it*/
+struct program_hooks {
+	struct engine { /*an engine of the differential harness*/
+		const char* name;
+		std::function<compact_tree()> build;
+		bool exact; /*the engine gives the minimum cut of every pair, so the harness fails if it differs from the maximum flows*/
+	};
+	const char* name; /*name of the program in the reports*/
+	std::function<void()> redraw; /*draws new capacities for G before the server rebuilds the tree on SIGHUP. Empty if the capacities never change*/
+	vector<engine> engines; /*engines of the program's own that the differential harness compares with the others*/
+};
+
+/*live_readers runs the LIVE_READERS threads that ask random settled pairs while build_tree grows the tree of a graph of n nodes, and checks their first
+answers against the finished tree. The tree is also published for the threshold queries. Without LIVE_READERS and THRESHOLD_QUERIES it does nothing*/
+class live_readers {
+public:
+	live_readers(size_t n, cut_context& ctx); /*publishes the builds that use ctx and starts the readers*/
+	~live_readers() { stop(); }
+	void stop(); /*the build is over: the readers finish*/
+	void report(const compact_tree& tree) const;
+	const live_tree& tree() const { return live; } /*stays valid, and complete, after stop*/
+private:
+	live_tree live;
+	cut_context& ctx;
+	std::atomic<bool> building;
+	vector<vector<pair<pair<vertex_d, vertex_d>, int> > > answers; /*the first answers of every reader, to check against the finished tree*/
+	vector<vector<pair<pair<vertex_d, vertex_d>, int> > > bounds; /*the first upper bounds of every reader for pairs that were not settled*/
+	vector<size_t> counts, bounded; /*number of answers and of upper bounds of every reader*/
+	vector<thread> threads;
+};
+
+/*threshold_reader asks THRESHOLD_QUERIES random pairs whether their minimum cut reaches THRESHOLD_K on a thread of its own, while the tree of G is built into
+live. A pair is answered from the tree as soon as live_tree::at_least proves the answer, and only with a flow that stops at THRESHOLD_K units when it does not,
+so the later pairs of an exact build need no flow at all. With THRESHOLD_CHECK every answer is compared with the full flow of the pair. Without
+THRESHOLD_QUERIES it does nothing*/
+class threshold_reader {
+public:
+	threshold_reader(const Graph& G, const edge_property_map& val, const live_tree* live); /*starts asking. Without live every pair is answered with a flow*/
+	~threshold_reader() { stop(); }
+	void stop(); /*waits until every pair is answered*/
+	void report() const;
+private:
+	void ask(const Graph& G, const edge_property_map& val, const live_tree* live, unsigned int seed);
+
+	size_t asked, yes, yes_from_tree, no_from_tree, differ, witness_nodes;
+	long long bounded_us, full_us;
+	thread asker;
+};
+
+template <class GraphT, class ValueMap>
+pair<vector<vertex_d>, int> minimum_cut(vertex_d s, vertex_d t, const ValueMap& val, const GraphT& G, cut_context& ctx);
+template <class GraphT, class ValueMap>
+vertex_d locate(tree_edge_index& tree_index, const GraphT& G, vertex_d p, const ValueMap& Gvals, cut_context& ctx);
+compact_tree build_seperator_tree(const Graph& G, const edge_property_map& value_map, cut_context& ctx, double epsilon);
+compact_tree build_with_engine(const Graph& G, const edge_property_map& value_map, cut_context& ctx);
+vector<vertex_d> locality_order(const Graph& G);
+Graph relabel_graph(const Graph& G, const edge_property_map& val, const vector<vertex_d>& old_id);
+template <class GraphT, class ValueMap>
+compact_tree build_tree(const GraphT& G, const ValueMap& value_map, cut_context& ctx, const compact_tree* kept = NULL, vertex_d keep = 0, const vector<vertex_d>* old_id = NULL);
+template <class DirectionTag>
+compact_tree build_distributed(const Graph& G, const edge_property_map& val, int workers, DirectionTag, live_tree* live = NULL);
+vector<vector<int> > numa_nodes();
+bool pin_to_cpus(const vector<int>& cpus);
+template <class DirectionTag>
+compact_tree gusfield_tree(const Graph& G, const edge_property_map& val, DirectionTag, live_tree* live = NULL);
+template <class CutNetwork>
+compact_tree gusfield_cuts(size_t n, CutNetwork& network, live_tree* live = NULL);
+Graph sparsify(const Graph& G, const edge_property_map& val, double epsilon);
+void report_approximation(const compact_tree& tree, const Graph& G, const edge_property_map& val, double epsilon);
+const char* broken_invariant(const compact_tree& tree, size_t n);
+int differential_report(const Graph& G, const edge_property_map& val, const program_hooks& program);
+compact_tree stream_updates(Graph& G, edge_property_map& val, cut_context& ctx, const compact_tree& first, double epsilon, const char* path,
+	std::function<void(std::shared_ptr<const compact_tree>)> publish);
+pair<vector<vertex_d>, int> global_minimum_cut(const Graph& G, const edge_property_map& val, int method);
+pair<vector<char>, long long> nagamochi_ibaraki(vector<contracted_edge> edges, int n);
+vector<contracted_edge> contract_edges(const vector<contracted_edge>& edges, const vector<int>& label, int n);
+void add_edges_bulk(Graph& G, const vector<pair<vertex_d, vertex_d> >& edge_list);
+int run_all_pairs(Graph& G, edge_property_map& value_map, const program_hooks& program, int argc, char* argv[], scoped_timer& run);
+template <class GraphT, class ValueMap>
+int run_all_pairs(const GraphT& G, const ValueMap& value_map, const program_hooks& program, int argc, char* argv[], scoped_timer& run);
+template <class GraphT, class ValueMap>
+compact_tree build_seperator_tree(const GraphT& G, const ValueMap& value_map, cut_context& ctx);
+void write_results(const compact_tree& tree);
+void report_build(double seconds, const cut_cache& cache, const compact_tree& tree);
+void finish_trace(scoped_timer& run);
+inline void report_graph(const shard_graph& G) {
+	cout << "Out of core -> " << G.disk_bytes() << " bytes on disk, " << G.loads() << " shard loads, at most " << G.peak_bytes() << " bytes in memory" << endl;
+}
+template <class GraphT>
+void report_graph(const GraphT&) {}
+
+/*This function builds the seperator tree of G with the capacities of value_map. If epsilon is not 0 the tree is built on a sparsified copy of G instead,
+whose cuts are within a factor 1 +- epsilon of the cuts of G*/
+inline compact_tree build_seperator_tree(const Graph& G, const edge_property_map& value_map, cut_context& ctx, double epsilon) {
+	if (epsilon > 0) {
+		Graph H = sparsify(G, value_map, epsilon);
+		if (ctx.cache != NULL) ctx.cache->invalidate(); /*from here on the cache holds cuts of H, so it has to be invalidated again before it is used with G*/
+		return build_seperator_tree(H, get(&EdgeProperty::value, H), ctx, 0);
+	}
+#if REORDER_VERTICES && CUT_ENGINE == ENGINE_HEURISTIC
+	vector<vertex_d> old_id = locality_order(G);
+	Graph R = relabel_graph(G, value_map, old_id);
+	if (ctx.cache != NULL) ctx.cache->invalidate(); /*the cache holds cuts by node id, and the ids of R are not the ids of G*/
+	return build_tree(R, get(&EdgeProperty::value, R), ctx, NULL, 0, &old_id); /*the nodes of R are processed in the order of their ids in G*/
+#endif
+	return build_with_engine(G, value_map, ctx);
+}
+
+/*This function builds the seperator tree of G with the engine that was chosen at compile time*/
+inline compact_tree build_with_engine(const Graph& G, const edge_property_map& value_map, cut_context& ctx) {
+#if CUT_ENGINE == ENGINE_GUSFIELD && BUILD_WORKERS > 0
+#if DIRECTED_GRAPH
+	return build_distributed(G, value_map, BUILD_WORKERS, directed_tag(), ctx.live);
+#else
+	return build_distributed(G, value_map, BUILD_WORKERS, undirected_tag(), ctx.live);
+#endif
+#elif CUT_ENGINE == ENGINE_GUSFIELD
+#if DIRECTED_GRAPH
+	return gusfield_tree(G, value_map, directed_tag(), ctx.live);
+#else
+	return gusfield_tree(G, value_map, undirected_tag(), ctx.live);
+#endif
+#endif
+	return build_tree(G, value_map, ctx);
+}
+
+/*This function builds the seperator tree of any graph that offers the functions minimum_cut uses (a Graph or a shard_graph). If old_id is given G is a copy
+whose node v is node old_id[v] of the original graph (see relabel_graph). The nodes are then processed in the order of their original ids and the tree is
+returned with the original ids, so that the copy only changes where the adjacency lists lie in memory and not the tree*/
+template <class GraphT, class ValueMap>
+compact_tree build_tree(const GraphT& G, const ValueMap& value_map, cut_context& ctx, const compact_tree* kept, vertex_d keep, const vector<vertex_d>* old_id) {
+	vertex_d u, k;
+	int value;
+	compact_tree tree(num_vertices(G)); /*the seperator tree T: the parent and the minimum cut value of every node*/
+	tree_edge_index tree_index(num_vertices(G)); /*the tree edges by value and the degree of every node of G, while the seperator tree grows*/
+	vector<vertex_d> new_id; /*the node of G of every original id*/
+	if (old_id != NULL) {
+		new_id.resize(num_vertices(G));
+		for (vertex_d v = 0; v < num_vertices(G); v++) new_id[(*old_id)[v]] = v;
+	}
+	if (ctx.live != NULL) ctx.live->reset();
+
+	/*This for is the heart of the program. It calls the essential functions locate and minimum_cut that create the seperator tree*/
+	for (vertex_d i = 0; i < num_vertices(G); i++) {
+		if (i == 0) continue; /*obviously at the start the seperator tree is considered empty so we simply add the first node in the tree*/
+		else {
+			u = (old_id != NULL) ? new_id[i] : i; /*the node of G that is added at this step*/
+			if (i < keep) k = kept->parent(i); /*a repair keeps the place of the first nodes and only computes their cut again*/
+			else if (i == 1) k = (old_id != NULL) ? new_id[0] : 0; /*obviously the second node of the seperator tree can only be linked with the first one, since it is a singleton*/
+			else k = locate(tree_index, G, u, value_map, ctx);	/*recursively find the node of the seperator tree that node i has to be linked with*/
+			value = minimum_cut(u, k, value_map, G, ctx).second;
+			tree_index.link(u, k, value); /*the index follows every edge that is added to the seperator tree*/
+			if (old_id != NULL) k = (*old_id)[k];
+			tree.attach(i, k, value); /*Now that k is found we link i with it through an edge whose capacity is equal to the minimum cut of the start and end nodes*/
+			if (ctx.live != NULL) ctx.live->settle(i, k, value); /*from here on readers may ask for i*/
+		}
+	}
+#if TREE_DELTA_ENCODE
+	tree.encode_deltas();
+#endif
+	return tree;
+}
+
+
+template <class GraphT, class ValueMap>
+pair<vector<vertex_d>, int> minimum_cut(vertex_d s, vertex_d t, const ValueMap& val, const GraphT& G, cut_context& ctx) {
+	scoped_timer timer("minimum_cut", s);
+	typename graph_traits<GraphT>::out_edge_iterator ei, ei_end; /*checks for the edges that come out from a specific node*/
+	if (ctx.pred.size() < num_vertices(G)) { /*make sure the context can hold one entry per node of G*/
+		ctx.pred.resize(num_vertices(G));
+		ctx.visited.resize(num_vertices(G));
+	}
+	vector<vertex_d>& pred = ctx.pred; /*predecessor map of this call*/
+	vector<int>& visited = ctx.visited; /*visited map of this call (see cut_context::new_search)*/
+	if (ctx.cache != NULL) { /*a pair that was already computed costs only a lookup*/
+		const pair<vector<vertex_d>, int>* cached = ctx.cache->lookup(s, t);
+		if (cached != NULL) return *cached;
+	}
+	cut_session<GraphT> session(G); /*the shards of an out of core graph stay loaded until the cut is done*/
+	int spread = 1; /*spread variable is used as a search limit. If it's 1 it checks for the neighboor nodes of starting node, if it's 2 it checks for the neighboors of the neighboors of the starting node and so on*/
+
+	int min_cut = INT_MAX; /*initialization with the maximum integer*/
+	int sum = 0;
+
+	vector<vertex_d> source_adj, target_adj, cut_set_A; /*these vectors will be used to store information about the neighbooring nodes in the searching process. Cut_set_A is used to store the first set after the cut*/
+
+	vector<vertex_d> temp_source;
+
+	for (tie(ei, ei_end) = out_edges(s, G); ei != ei_end; ei++) { /*for all edges that come out of node s*/
+		if (target(*ei, G) != t) {
+			source_adj.push_back(target(*ei, G)); /*store neighboor nodes*/
+		}
+		sum += val[*ei]; /*store the cost of the cut as the sum of the capacities that are in the cut*/
+	}
+	if (sum < min_cut) { /*store the minimum cut in the first set*/
+		cut_set_A.clear();
+		min_cut = sum;
+		cut_set_A.push_back(s);
+	}
+	vertex_d next_s;
+	int temp = sum;
+	for (int i = 0; i < source_adj.size(); i++) { /*for each neighbooring node*/
+		next_s = source_adj[i]; /*check the other nodes*/
+		pred[next_s] = s;
+		/*all other nodes become "not visited" with a new stamp, so we don't have to go through the whole graph for every neighboor*/
+		int stamp = ctx.new_search();
+		visited[s] = stamp; /*obviously we mark the node that we start from as visited*/
+		visited[t] = stamp; /*we also mark this starting node as visited since we also check for a cut that comes from this node*/
+		visited[next_s] = stamp; /*mark current node as visited*/
+
+		for (int j = 0; j < spread; j++) { /*for each neighboor (if spread = 1 then we only check for current node next_s)*/
+			temp = temp - val[edge(pred[next_s], next_s, G).first]; /*update the cut value correctly*/
+			/*for each neighboor of next_s node*/
+			size_t degree = out_degree(next_s, G); /*the source of every edge below*/
+			for (tie(ei, ei_end) = out_edges(next_s, G); ei != ei_end; ei++) {
+
+				if (degree >= 2) {
+
+					if (visited[target(*ei, G)] != stamp) {
+						temp_source.push_back(target(*ei, G));
+					}
+				}
+				else if (degree == 1) {
+					break;
+				}
+				if (target(*ei, G) != s)temp += val[*ei];
+
+			}
+			if (temp_source.empty()) {
+				break;
+			}
+			pred[*temp_source.begin()] = next_s;
+			next_s = *temp_source.begin();
+			visited[next_s] = stamp;
+			/*check if this cut value is minimum and if yes update the cut_set_A variable so that it contains the set of nodes that are cut from graph G*/
+			if (temp < min_cut) {
+				cut_set_A.clear();
+				min_cut = temp;
+				vertex_d prev_s = next_s;
+
+				for (int k = 0; k < temp_source.size(); k++) {
+					cut_set_A.push_back(pred[prev_s]);
+					prev_s = pred[prev_s];
+				}
+				cut_set_A.push_back(s);
+			}
+			temp_source.clear();
+
+		}
+
+		temp = sum;
+	}
+	/*the rest below are exactly the same as with node s but this time for node t instead.*/
+	sum = 0;
+	for (tie(ei, ei_end) = out_edges(t, G); ei != ei_end; ei++) {
+		if (target(*ei, G) != s) {
+			target_adj.push_back(target(*ei, G));
+
+		}
+		sum += val[*ei];
+	}
+
+	if (sum < min_cut) {
+		cut_set_A.clear();
+		min_cut = sum;
+		cut_set_A.push_back(t);
+	}
+	temp = sum;
+	vertex_d next_t;
+	vector<vertex_d> temp_target;
+	for (int i = 0; i < target_adj.size(); i++) {
+		next_t = target_adj[i];
+		pred[next_t] = t;
+
+		int stamp = ctx.new_search();
+		visited[s] = stamp;
+		visited[t] = stamp;
+		visited[next_t] = stamp;
+
+		for (int j = 0; j < spread; j++) {
+			temp = temp - val[edge(pred[next_t], next_t, G).first];
+
+			size_t degree = out_degree(next_t, G); /*the source of every edge below*/
+			for (tie(ei, ei_end) = out_edges(next_t, G); ei != ei_end; ei++) {
+
+				if (degree >= 2) {
+
+					if (visited[target(*ei, G)] != stamp) {
+						temp_target.push_back(target(*ei, G));
+					}
+				}
+				else if (degree == 1) {
+					break;
+				}
+				if (target(*ei, G) != t)temp += val[*ei];
+
+			}
+			if (temp_target.empty()) {
+				break;
+			}
+
+			pred[*temp_target.begin()] = next_t;
+			next_t = *temp_target.begin();
+			visited[next_t] = stamp;
+
+			if (temp < min_cut) {
+				cut_set_A.clear();
+				min_cut = temp;
+				vertex_d prev_t = next_t;
+
+				for (int k = 0; k < temp_target.size(); k++) {
+					cut_set_A.push_back(pred[prev_t]);
+					prev_t = pred[prev_t];
+				}
+				cut_set_A.push_back(t);
+			}
+
+			temp_target.clear();
+
+		}
+
+		temp = sum;
+	}
+
+	/*we create a pair of a vertex vector and and integer that together create the results that are returned by the function*/
+	pair<vector<vertex_d>, int> res;
+	res.first = cut_set_A; /*right now cut_set_A should contain the subset of nodes that are cut from graph G*/
+	res.second = min_cut; /*min_cut should contain the correct value of the minimum cut that occured*/
+	if (ctx.cache != NULL) ctx.cache->insert(s, t, res);
+	return res;
+}
+
+/*This function returns the node of the seperator tree that p is linked to. It cuts the lightest tree edge that is left and follows the side of the cut that holds p
+until that side is a single node. When tree edges have the same value the walk can come back to edges it cut before and never end (Random does with seeds 2 to 4),
+so it is stopped after a few rounds per tree edge and p is linked to the end of the last cut edge on its own side*/
+template <class GraphT, class ValueMap>
+vertex_d locate(tree_edge_index& tree_index, const GraphT& G, vertex_d p, const ValueMap& Gvals, cut_context& ctx) {
+	scoped_timer timer("locate", p);
+	vertex_d k;
+	vertex_d singleton = 0;
+	pair<vector<vertex_d>, int> cut;
+	int min = INT_MAX;
+	char direction; /*This variable shows in which direction of the cut within the seperator tree lies our node k*/
+	vertex_d a = 0, b = 0, a_cand = 0, b_cand = 0; /*vertex a and b are the nodes that have the minimum cut within the seperator tree*/
+	int found = 0;
+	int check = 0;
+	int threshold = 0;
+	int attempts = 0; /*since we use an infinite loop we use the variable attempts to force exit the while loop in case of an undefined random state*/
+	vertex_d rounds = 0, max_rounds = 4 * (tree_index.edges() + 1) + 64; /*a walk that ends visits every tree edge a few times at most*/
+
+	while (1) {
+		if (++rounds > max_rounds) {
+			singleton = ((direction == 'b') == (found == 1)) ? b : a;
+			break;
+		}
+		direction = 'n'; /*initialize the direction with 'nothing'*/
+
+		min = INT_MAX;
+		found = 0;
+		check = 0;
+		/*we locate the minimum a-b minimum cut candidates. tree_index keeps the tree edges ordered by value, so this is a lookup instead of a scan over the whole tree*/
+		if (tree_index.lightest_edge(threshold, a, b, a_cand, b_cand, min)) check = 1;
+		/*we update threshold to avoid falling into infinite loops but at the same time check every possible edge even if more than two edges have the same capacity*/
+		if (threshold == min) attempts++;
+		threshold = min;
+		if (attempts == 2) { /*if the program is stuck more than 2 times looking at the same edge then force it to move on by increasing threshold by one*/
+			attempts = 0;
+			threshold++;
+		}
+		a = a_cand;
+		b = b_cand;
+
+		cut = minimum_cut(a, b, Gvals, G, ctx); /*return the value of the minimum cut and the cut_set_A between nodes a and b*/
+
+		/*the rest of this code checks where k is within the a-b cut and repeats the while loop until it gets into a singleton set*/
+		for (int i = cut.first.size() - 1; i >= 0; i--) {
+			if (cut.first[i] == a) direction = 'a';
+			else if (cut.first[i] == b) direction = 'b';
+		}
+
+		for (int i = cut.first.size() - 1; i >= 0; i--) {
+			if (cut.first[i] == p) found = 1;
+		}
+		if (found == 1 && direction == 'a') {
+			if (cut.first.size() == 2) {
+				singleton = a;
+				break;
+			}
+
+		}
+		else if (found == 1 && direction == 'b') {
+			if (cut.first.size() == 2) {
+				singleton = b;
+				break;
+			}
+
+
+		}
+		else if (found == 0 && direction == 'a') {
+			if (tree_index.degree(b) == 1) {
+				singleton = b;
+				break;
+			}
+			if (check == 0) {
+				singleton = b;
+				break;
+			}
+
+
+		}
+		else if (found == 0 && direction == 'b') {
+			if (tree_index.degree(a) == 1) {
+				singleton = a;
+				break;
+			}
+			if (check == 0) {
+				singleton = a;
+				break;
+			}
+
+
+		}
+
+	}
+	k = singleton; /*k should now contain the correct singleton node*/
+	return k; /*we return the singleton node k*/
+}
+
+/*This function returns a copy of G whose capacities are sampled so that every cut keeps its value within a factor 1 +- epsilon with high probability (Karger's
+sampling). Every unit of capacity is kept with probability p = min(1, APPROX_SAMPLING * ln(n) / (epsilon^2 * c)), where c is the global minimum cut of G
+(the smallest one over the connected components, computed exactly with nagamochi_ibaraki), and the kept units are scaled back by 1/p. The guarantee needs c
+to be at most the minimum cut, so an upper bound like the smallest weighted degree would make p too small. Edges that keep no capacity at all are left out of
+the copy*/
+inline Graph sparsify(const Graph& G, const edge_property_map& val, double epsilon) {
+	edge_t ei, ei_end;
+	vertex_t vi, vi_end;
+	size_t n = num_vertices(G);
+	Graph H(n);
+	for (tie(vi, vi_end) = vertices(G); vi != vi_end; vi++) H[*vi] = G[*vi]; /*node capacities are kept as they are*/
+
+	/*the edges of every connected component, with the nodes numbered inside their component*/
+	vector<int> component(n), index(n), sizes;
+	if (n > 0) sizes.resize(connected_components(G, &component[0]), 0);
+	for (vertex_d v = 0; v < n; v++) index[v] = sizes[component[v]]++;
+	vector<vector<contracted_edge> > component_edges(sizes.size());
+	for (tie(ei, ei_end) = edges(G); ei != ei_end; ei++) {
+		vertex_d u = source(*ei, G), v = target(*ei, G);
+		contracted_edge e = { index[u], index[v], val[*ei] };
+		if (u != v) component_edges[component[u]].push_back(e);
+	}
+	long long c = LLONG_MAX;
+	for (size_t k = 0; k < sizes.size(); k++) {
+		if (sizes[k] > 1) c = min(c, nagamochi_ibaraki(component_edges[k], sizes[k]).second);
+	}
+	double p = 1.0;
+	if (c > 0 && c != LLONG_MAX) p = min(1.0, APPROX_SAMPLING * log((double)n) / (epsilon * epsilon * (double)c));
+	std::mt19937 gen(rand());
+	for (tie(ei, ei_end) = edges(G); ei != ei_end; ei++) {
+		int kept = val[*ei];
+		if (p < 1.0) {
+			std::binomial_distribution<int> units(val[*ei], p);
+			kept = (int)(units(gen) / p + 0.5);
+		}
+		if (kept > 0) {
+			edge_d e = add_edge(source(*ei, G), target(*ei, G), H).first;
+			H[e].value = kept;
+		}
+	}
+	cout << "Sparsified graph -> " << num_edges(H) << " of " << num_edges(G) << " edges kept, capacity units sampled with p = " << p << endl;
+	return H;
+}
+
+/*This function estimates the error of a tree built in approximate mode. For APPROX_CHECKS random tree edges it compares the value stored in the tree with the
+maximum flow between the same two nodes in G itself, and prints the mean, the standard deviation and the largest relative error*/
+inline void report_approximation(const compact_tree& tree, const Graph& G, const edge_property_map& val, double epsilon) {
+	if (tree.size() < 2) return;
+#if DIRECTED_GRAPH
+	flow_network<directed_tag> net(G, val);
+#else
+	flow_network<undirected_tag> net(G, val);
+#endif
+	double sum = 0, sum_sq = 0, max_err = 0;
+	int checks = 0;
+	for (int c = 0; c < APPROX_CHECKS; c++) {
+		vertex_d v = 1 + rand() % (tree.size() - 1);
+		long long exact = net.cut(v, tree.parent(v)).second;
+		if (exact <= 0) continue;
+		double err = fabs((double)tree.value(v) - exact) / exact;
+		sum += err;
+		sum_sq += err * err;
+		max_err = max(max_err, err);
+		checks++;
+	}
+	if (checks == 0) return;
+	double mean = sum / checks;
+	double sd = sqrt(max(0.0, sum_sq / checks - mean * mean));
+	cout << "Approximation -> epsilon = " << epsilon << ", relative error " << mean << " +- " << sd << " (max " << max_err << ") over " << checks << " tree edges" << endl;
+}
+
+/*This function returns the global minimum cut of G: the value of the smallest cut that splits G in two and the nodes of one of the two sides. It uses either the
+contractions of Nagamochi, Ono and Ibaraki or the heap based Stoer-Wagner algorithm of the boost library*/
+inline pair<vector<vertex_d>, int> global_minimum_cut(const Graph& G, const edge_property_map& val, int method) {
+	pair<vector<vertex_d>, int> res;
+	size_t n = num_vertices(G);
+	if (n < 2) {
+		res.second = 0;
+		return res;
+	}
+	if (method == GLOBAL_STOER_WAGNER) {
+		one_bit_color_map<> parity(n);
+		res.second = stoer_wagner_min_cut(G, val, parity_map(parity));
+		for (vertex_d v = 0; v < n; v++) {
+			if (get(parity, v)) res.first.push_back(v);
+		}
+		return res;
+	}
+	vector<contracted_edge> graph_edges;
+	graph_edges.reserve(num_edges(G));
+	edge_t ei, ei_end;
+	for (tie(ei, ei_end) = edges(G); ei != ei_end; ei++) {
+		contracted_edge e = { (int)source(*ei, G), (int)target(*ei, G), val[*ei] };
+		if (e.u != e.v) graph_edges.push_back(e);
+	}
+	pair<vector<char>, long long> cut = nagamochi_ibaraki(graph_edges, (int)n);
+	res.second = (int)min(cut.second, (long long)INT_MAX);
+	for (vertex_d v = 0; v < n; v++) {
+		if (cut.first[v]) res.first.push_back(v);
+	}
+	return res;
+}
+
+/*The minimum cut of the graph of n nodes given by edges, with the contractions of Nagamochi, Ono and Ibaraki. Every round the lightest node (its edges are a cut)
+bounds the minimum cut from above by best, and a scan in maximum adjacency order gives every edge (x, y) a lower bound r(y) on the minimum cut of x and y,
+the capacity from y to the nodes scanned before it. Edges whose bound reaches best can be contracted, since no cut below best separates their ends, and so can
+the last two nodes of the scan, whose minimum cut is the edges of the last node. So every round contracts at least one edge and usually most of them, and costs
+O(m log m). It returns the side of every node (1 for the side of the lightest node) and the value*/
+inline pair<vector<char>, long long> nagamochi_ibaraki(vector<contracted_edge> edges, int n) {
+	int n0 = n;
+	vector<int> owner(n0); /*the contracted node every node of the input is in*/
+	for (int v = 0; v < n0; v++) owner[v] = v;
+	pair<vector<char>, long long> best(vector<char>(n0, 0), LLONG_MAX);
+	while (n > 1) {
+		vector<int> first(n + 1, 0), to(2 * edges.size()); /*the adjacency of the contracted graph*/
+		vector<long long> weight(2 * edges.size()), degree(n, 0);
+		for (size_t e = 0; e < edges.size(); e++) {
+			first[edges[e].u + 1]++;
+			first[edges[e].v + 1]++;
+			degree[edges[e].u] += edges[e].w;
+			degree[edges[e].v] += edges[e].w;
+		}
+		for (int x = 0; x < n; x++) first[x + 1] += first[x];
+		vector<int> fill(first.begin(), first.end() - 1);
+		for (size_t e = 0; e < edges.size(); e++) {
+			to[fill[edges[e].u]] = edges[e].v;
+			weight[fill[edges[e].u]++] = edges[e].w;
+			to[fill[edges[e].v]] = edges[e].u;
+			weight[fill[edges[e].v]++] = edges[e].w;
+		}
+		int lightest = min_element(degree.begin(), degree.end()) - degree.begin();
+		if (degree[lightest] < best.second) {
+			best.second = degree[lightest];
+			for (int v = 0; v < n0; v++) best.first[v] = (owner[v] == lightest);
+		}
+
+		vector<int> root(n); /*union-find of the nodes that are contracted this round*/
+		for (int x = 0; x < n; x++) root[x] = x;
+		auto find = [&](int x) {
+			while (root[x] != x) x = root[x] = root[root[x]];
+			return x;
+		};
+		vector<long long> r(n, 0);
+		vector<char> scanned(n, 0);
+		priority_queue<pair<long long, int> > heap;
+		heap.push(make_pair(0LL, 0));
+		int count = 0, last = -1, before_last = -1;
+		while (!heap.empty()) {
+			pair<long long, int> top = heap.top();
+			heap.pop();
+			int x = top.second;
+			if (scanned[x] || top.first != r[x]) continue; /*an old entry of x*/
+			scanned[x] = 1;
+			count++;
+			before_last = last;
+			last = x;
+			for (int k = first[x]; k < first[x + 1]; k++) {
+				int y = to[k];
+				if (scanned[y]) continue;
+				r[y] += weight[k];
+				if (r[y] >= best.second) root[find(x)] = find(y);
+				heap.push(make_pair(r[y], y));
+			}
+		}
+		if (count < n) { /*the scan did not reach every node: the graph is not connected*/
+			best.second = 0;
+			for (int v = 0; v < n0; v++) best.first[v] = scanned[owner[v]];
+			break;
+		}
+		root[find(before_last)] = find(last);
+
+		vector<int> label(n, -1);
+		int next = 0;
+		for (int x = 0; x < n; x++) {
+			int top = find(x);
+			if (label[top] == -1) label[top] = next++;
+			label[x] = label[top];
+		}
+		for (int v = 0; v < n0; v++) owner[v] = label[owner[v]];
+		edges = contract_edges(edges, label, next);
+		n = next;
+	}
+	return best;
+}
+
+/*This function returns the edges between the contracted nodes of the graph given by edges, where node x becomes node label[x] of n. Edges inside a
+contracted node are dropped and parallel edges are merged, in O(m) with a marker per node*/
+inline vector<contracted_edge> contract_edges(const vector<contracted_edge>& edges, const vector<int>& label, int n) {
+	vector<int> first(n + 1, 0);
+	for (size_t e = 0; e < edges.size(); e++) {
+		int a = label[edges[e].u], b = label[edges[e].v];
+		if (a != b) first[min(a, b) + 1]++;
+	}
+	for (int x = 0; x < n; x++) first[x + 1] += first[x];
+	vector<int> fill(first.begin(), first.end() - 1);
+	vector<pair<int, long long> > by_low(first[n]); /*the edges grouped by their lower end*/
+	for (size_t e = 0; e < edges.size(); e++) {
+		int a = label[edges[e].u], b = label[edges[e].v];
+		if (a != b) by_low[fill[min(a, b)]++] = make_pair(max(a, b), edges[e].w);
+	}
+	vector<contracted_edge> res;
+	vector<int> at(n, -1); /*where the edge from the current lower end to every node is in res*/
+	for (int a = 0; a < n; a++) {
+		size_t begin = res.size();
+		for (int k = first[a]; k < first[a + 1]; k++) {
+			int b = by_low[k].first;
+			if (at[b] == -1) {
+				at[b] = res.size();
+				contracted_edge e = { a, b, 0 };
+				res.push_back(e);
+			}
+			res[at[b]].w += by_low[k].second;
+		}
+		for (size_t i = begin; i < res.size(); i++) at[res[i].v] = -1;
+	}
+	return res;
+}
+
+inline result_writer::result_writer(output_format format, const char* path, bool compress, size_t buffer_size)
+	: format(format), compress(compress), buffer_size(buffer_size), out(NULL), gz(NULL), pending(false), done(false), closed(false) {
+	front.reserve(buffer_size + 64);
+	back.reserve(buffer_size + 64);
+	bool to_stdout = (path == NULL || path[0] == '\0');
+#if OUTPUT_COMPRESS
+	if (compress) gz = to_stdout ? gzdopen(fileno(stdout), "wb") : gzopen(path, "wb");
+#else
+	this->compress = false; /*compression was not compiled in*/
+#endif
+	if (!this->compress) out = to_stdout ? stdout : fopen(path, format == FORMAT_BINARY ? "wb" : "w");
+	if (out == NULL && gz == NULL) {
+		cerr << "could not open output " << path << endl;
+		exit(1);
+	}
+	if (format == FORMAT_CSV) put("kind,u,v,value\n", 15);
+	worker = thread(&result_writer::run, this);
+}
+
+inline result_writer::~result_writer() {
+	close();
+}
+
+inline void result_writer::message(const char* text) {
+	if (format != FORMAT_TEXT) return;
+	put(text, strlen(text));
+	put("\n", 1);
+}
+
+inline void result_writer::tree_edge(vertex_d u, vertex_d v, int value) {
+	record(0, u, v, value);
+}
+
+inline void result_writer::pair_value(vertex_d i, vertex_d j, int value) {
+	record(1, i, j, value);
+}
+
+inline void result_writer::cluster_merge(size_t a, size_t b, int value) {
+	record(2, a, b, value);
+}
+
+inline void result_writer::group(vertex_d v, vertex_d g, int k) {
+	record(3, v, g, k);
+}
+
+inline void result_writer::side(vertex_d i, vertex_d j, vertex_d v) {
+	record(4, i, j, (int)v + 1);
+}
+
+inline void result_writer::record(int kind, vertex_d u, vertex_d v, int value) {
+	static const char* kinds[] = { "edge", "pair", "merge", "group", "side" };
+	switch (format) {
+	case FORMAT_TEXT:
+		if (kind == 0) {
+			put("there is an edge linking ", 25); put_int(u + 1); put(" and ", 5); put_int(v + 1); put(" and has a minimum cut of ", 26);
+		}
+		else if (kind == 1) {
+			put("Pair ", 5); put_int(u + 1); put(" and ", 5); put_int(v + 1); put(" has a minimum cut value of ", 28);
+		}
+		else if (kind == 2) {
+			put("Clusters ", 9); put_int(u + 1); put(" and ", 5); put_int(v + 1); put(" merge at a minimum cut of ", 27);
+		}
+		else if (kind == 3) {
+			put("Node ", 5); put_int(u + 1); put(" is in the group of node ", 25); put_int(v + 1); put(" at a minimum cut threshold of ", 31);
+		}
+		else if (kind == 4) {
+			put("Pair ", 5); put_int(u + 1); put(" and ", 5); put_int(v + 1); put(" has on the side of the first node the node ", 44);
+		}
+		put_int(value);
+		put("\n", 1);
+		break;
+	case FORMAT_CSV:
+		put(kinds[kind], strlen(kinds[kind])); put(",", 1); put_int(u + 1); put(",", 1); put_int(v + 1); put(",", 1); put_int(value); put("\n", 1);
+		break;
+	case FORMAT_JSONL:
+		put("{\"kind\":\"", 9); put(kinds[kind], strlen(kinds[kind])); put("\",\"u\":", 6); put_int(u + 1);
+		put(",\"v\":", 5); put_int(v + 1);
+		put(",\"value\":", 9); put_int(value); put("}\n", 2);
+		break;
+	case FORMAT_BINARY: {
+		unsigned char rec[13];
+		unsigned int fields[3] = { (unsigned int)(u + 1), (unsigned int)(v + 1), (unsigned int)value };
+		rec[0] = (unsigned char)kind;
+		for (int f = 0; f < 3; f++) {
+			for (int b = 0; b < 4; b++) rec[1 + 4 * f + b] = (unsigned char)(fields[f] >> (8 * b));
+		}
+		put((const char*)rec, 13);
+		break;
+	}
+	}
+}
+
+inline void result_writer::put(const char* data, size_t len) {
+	front.append(data, len);
+	if (front.size() >= buffer_size) hand_over();
+}
+
+/*integer formatting without going through iostreams*/
+inline void result_writer::put_int(long long x) {
+	char digits[24];
+	int n = 0;
+	bool negative = x < 0;
+	unsigned long long y = negative ? -(unsigned long long)x : (unsigned long long)x;
+	do {
+		digits[n++] = '0' + (char)(y % 10);
+		y /= 10;
+	} while (y != 0);
+	if (negative) front.push_back('-');
+	while (n > 0) front.push_back(digits[--n]);
+}
+
+inline void result_writer::hand_over() {
+	unique_lock<mutex> lock(m);
+	cv.wait(lock, [this] { return !pending; }); /*wait until the background thread has written the previous buffer*/
+	front.swap(back);
+	pending = true;
+	cv.notify_all();
+}
+
+inline void result_writer::run() {
+	unique_lock<mutex> lock(m);
+	while (1) {
+		cv.wait(lock, [this] { return pending || done; });
+		if (!pending && done) break;
+		lock.unlock(); /*the computing thread keeps filling front while back is written*/
+#if OUTPUT_COMPRESS
+		if (compress) gzwrite((gzFile)gz, back.data(), (unsigned int)back.size());
+		else
+#endif
+		fwrite(back.data(), 1, back.size(), out);
+		lock.lock();
+		back.clear();
+		pending = false;
+		cv.notify_all();
+	}
+}
+
+inline void result_writer::close() {
+	if (closed) return;
+	closed = true;
+	if (!front.empty()) hand_over();
+	{
+		lock_guard<mutex> lock(m);
+		done = true;
+	}
+	cv.notify_all();
+	worker.join();
+#if OUTPUT_COMPRESS
+	if (compress) {
+		gzclose((gzFile)gz);
+		return;
+	}
+#endif
+	if (out == stdout) fflush(out);
+	else fclose(out);
+}
+
+inline jump_tree::jump_tree(size_t n) : up(n), depth(n, 0), weight(n, INT_MAX), jump(n), low(n) {
+	for (vertex_d v = 0; v < n; v++) up[v] = jump[v] = low[v] = v;
+}
+
+inline void jump_tree::link(vertex_d child, vertex_d p, int value) {
+	up[child] = p;
+	weight[child] = value;
+	depth[child] = depth[p] + 1;
+	if (depth[p] - depth[jump[p]] == depth[jump[p]] - depth[jump[jump[p]]]) { /*two jumps of the same length merge into one*/
+		jump[child] = jump[jump[p]];
+		low[child] = lighter(child, lighter(low[p], low[jump[p]]));
+	}
+	else {
+		jump[child] = p;
+		low[child] = child;
+	}
+}
+
+inline vertex_d jump_tree::lightest(vertex_d u, vertex_d v) const {
+	vertex_d best = (depth[u] >= depth[v]) ? u : v;
+	if (depth[u] < depth[v]) swap(u, v);
+	while (depth[u] > depth[v]) { /*bring u up to the depth of v*/
+		if (depth[jump[u]] >= depth[v]) {
+			best = lighter(best, low[u]);
+			u = jump[u];
+		}
+		else {
+			best = lighter(best, u);
+			u = up[u];
+		}
+	}
+	while (u != v) { /*then both up to their common ancestor. Nodes of the same depth have jumps of the same length*/
+		if (jump[u] != jump[v]) {
+			best = lighter(lighter(best, low[u]), low[v]);
+			u = jump[u];
+			v = jump[v];
+		}
+		else {
+			best = lighter(lighter(best, u), v);
+			u = up[u];
+			v = up[v];
+		}
+	}
+	return best;
+}
+
+inline int jump_tree::path_min(vertex_d u, vertex_d v) const {
+	return (u == v) ? INT_MAX : weight[lightest(u, v)];
+}
+
+inline bool jump_tree::below(vertex_d x, vertex_d w) const {
+	while (depth[x] > depth[w]) x = (depth[jump[x]] >= depth[w]) ? jump[x] : up[x];
+	return x == w;
+}
+
+inline tree_edge_index::tree_edge_index(size_t n) : paths(n), deg(n, 0) {}
+
+inline void tree_edge_index::link(vertex_d child, vertex_d parent, int value) {
+	paths.link(child, parent, value);
+	deg[child]++;
+	deg[parent]++;
+	by_value.insert(make_pair(value, added.size()));
+	added.push_back(make_pair(child, parent));
+}
+
+inline bool tree_edge_index::on_side(vertex_d x, vertex_d a, vertex_d b) const {
+	bool a_below = (paths.parent(a) == b); /*the edge hangs a below b or b below a*/
+	return paths.below(x, a_below ? a : b) == a_below;
+}
+
+inline bool tree_edge_index::lightest_edge(int threshold, vertex_d a, vertex_d b, vertex_d& u, vertex_d& v, int& value) {
+	set<pair<int, size_t>>::iterator it = by_value.lower_bound(make_pair(threshold, (size_t)0));
+	if (it != by_value.end() && added[it->second].first == a && added[it->second].second == b) it++; /*skip the edge we just checked*/
+	if (it == by_value.end()) return false;
+	u = added[it->second].first;
+	v = added[it->second].second;
+	value = it->first;
+	return true;
+}
+
+inline cut_cache::cut_cache(size_t max_bytes) : max_bytes(max_bytes), used_bytes(0), n_hits(0), n_misses(0) {}
+
+inline const pair<vector<vertex_d>, int>* cut_cache::lookup(vertex_d s, vertex_d t) {
+	map<pair<vertex_d, vertex_d>, list<entry>::iterator>::iterator it = index.find(make_pair(s, t));
+	if (it == index.end()) {
+		n_misses++;
+		return NULL;
+	}
+	n_hits++;
+	lru.splice(lru.begin(), lru, it->second); /*move the pair to the front*/
+	return &it->second->cut;
+}
+
+inline void cut_cache::insert(vertex_d s, vertex_d t, const pair<vector<vertex_d>, int>& cut) {
+	if (max_bytes == 0 || index.count(make_pair(s, t))) return;
+	entry e;
+	e.s = s;
+	e.t = t;
+	e.cut = cut;
+	size_t size = entry_bytes(e);
+	if (size > max_bytes) return;
+	while (used_bytes + size > max_bytes) { /*evict the least recently used pairs*/
+		used_bytes -= entry_bytes(lru.back());
+		index.erase(make_pair(lru.back().s, lru.back().t));
+		lru.pop_back();
+	}
+	lru.push_front(e);
+	index[make_pair(s, t)] = lru.begin();
+	used_bytes += size;
+}
+
+inline void cut_cache::invalidate() {
+	lru.clear();
+	index.clear();
+	used_bytes = 0;
+}
+
+/*approximate memory held by an entry: the list node, the map node and the cut set*/
+inline size_t cut_cache::entry_bytes(const entry& e) const {
+	return sizeof(entry) + 2 * sizeof(void*) + sizeof(pair<vertex_d, vertex_d>) + sizeof(list<entry>::iterator) + 4 * sizeof(void*) + e.cut.first.size() * sizeof(vertex_d);
+}
+
+inline packed_array::packed_array(size_t n, unsigned long long max_value) : n(n), bytes_per_value(width_for(max_value)), data(n * width_for(max_value), 0) {}
+
+inline int packed_array::width_for(unsigned long long x) {
+	if (x <= 0xFFULL) return 1;
+	if (x <= 0xFFFFULL) return 2;
+	if (x <= 0xFFFFFFFFULL) return 4;
+	return 8;
+}
+
+inline unsigned long long packed_array::get(size_t i) const {
+	switch (bytes_per_value) {
+	case 1: return data[i];
+	case 2: { uint16_t x; memcpy(&x, &data[2 * i], 2); return x; }
+	case 4: { uint32_t x; memcpy(&x, &data[4 * i], 4); return x; }
+	default: { uint64_t x; memcpy(&x, &data[8 * i], 8); return x; }
+	}
+}
+
+inline void packed_array::set(size_t i, unsigned long long x) {
+	int w = width_for(x);
+	if (w > bytes_per_value) { /*repack everything with the wider type*/
+		packed_array wider(n, x);
+		for (size_t j = 0; j < n; j++) wider.set(j, get(j));
+		data.swap(wider.data);
+		bytes_per_value = w;
+	}
+	switch (bytes_per_value) {
+	case 1: data[i] = (unsigned char)x; break;
+	case 2: { uint16_t y = (uint16_t)x; memcpy(&data[2 * i], &y, 2); break; }
+	case 4: { uint32_t y = (uint32_t)x; memcpy(&data[4 * i], &y, 4); break; }
+	default: { uint64_t y = x; memcpy(&data[8 * i], &y, 8); break; }
+	}
+}
+
+inline void packed_array::release() {
+	vector<unsigned char>().swap(data);
+}
+
+inline compact_tree::compact_tree(size_t n) : n(n), parents(n, n > 0 ? n - 1 : 0), values(n) {}
+
+inline void compact_tree::attach(vertex_d v, vertex_d parent, int value) {
+	parents.set(v, parent);
+	values.set(v, (unsigned long long)value);
+}
+
+inline vertex_d compact_tree::parent(vertex_d v) const {
+	if (delta_index.empty()) return (vertex_d)parents.get(v);
+	size_t pos = delta_index[v / DELTA_BLOCK];
+	unsigned long long z = 0;
+	for (size_t w = v - v % DELTA_BLOCK; w <= v; w++) { /*decode the varints from the start of the block up to v*/
+		z = 0;
+		int shift = 0;
+		while (1) {
+			unsigned char byte = deltas[pos++];
+			z |= (unsigned long long)(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) break;
+			shift += 7;
+		}
+	}
+	long long delta = (long long)(z >> 1) ^ -(long long)(z & 1); /*undo the zigzag*/
+	return (vertex_d)((long long)v - delta);
+}
+
+inline size_t compact_tree::bytes() const {
+	return parents.bytes() + values.bytes() + deltas.capacity() + delta_index.capacity() * sizeof(size_t);
+}
+
+inline vertex_d compact_tree::path_min_node(vertex_d u, vertex_d v) const {
+	int res = INT_MAX;
+	vertex_d node = u;
+	while (u != v) {
+		vertex_d& w = (u > v) ? u : v; /*step up from the larger of the two like path_min*/
+		if (value(w) < res) {
+			res = value(w);
+			node = w;
+		}
+		w = parent(w);
+	}
+	return node;
+}
+
+inline int compact_tree::path_min(vertex_d u, vertex_d v) const {
+	int res = INT_MAX;
+	/*every node is attached to a node with a smaller id, so stepping up from the larger of the two meets the other at their common ancestor*/
+	while (u != v) {
+		if (u > v) {
+			res = min(res, value(u));
+			u = parent(u);
+		}
+		else {
+			res = min(res, value(v));
+			v = parent(v);
+		}
+	}
+	return res;
+}
+
+inline void compact_tree::encode_deltas() {
+	deltas.clear();
+	delta_index.clear();
+	for (size_t v = 0; v < n; v++) {
+		if (v % DELTA_BLOCK == 0) delta_index.push_back(deltas.size());
+		long long delta = (long long)v - (long long)parents.get(v);
+		unsigned long long z = ((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63); /*zigzag so that small negative differences stay small*/
+		do {
+			unsigned char byte = z & 0x7F;
+			z >>= 7;
+			if (z != 0) byte |= 0x80;
+			deltas.push_back(byte);
+		} while (z != 0);
+	}
+	deltas.shrink_to_fit();
+	delta_index.shrink_to_fit();
+	parents.release();
+}
+
+static volatile sig_atomic_t server_signal = 0; /*last SIGHUP, SIGINT or SIGTERM that reached the server*/
+
+static void server_signal_handler(int sig) {
+	server_signal = sig;
+}
+
+/*read or write exactly len bytes*/
+static bool read_full(int fd, void* buf, size_t len) {
+	char* p = (char*)buf;
+	while (len > 0) {
+		ssize_t r = read(fd, p, len);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) return false;
+		p += r;
+		len -= r;
+	}
+	return true;
+}
+
+static bool write_full(int fd, const void* buf, size_t len) {
+	const char* p = (const char*)buf;
+	while (len > 0) {
+		ssize_t r = write(fd, p, len);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) return false;
+		p += r;
+		len -= r;
+	}
+	return true;
+}
+
+inline query_server::query_server(const char* path, int threads) : path(path), n_threads(threads), listen_fd(-1), epoll_fd(-1), wake_fd(-1), next_serial(0), stopping(false) {
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	unlink(path);
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0 || bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 128) < 0) {
+		cerr << "could not listen on " << path << ": " << strerror(errno) << endl;
+		exit(1);
+	}
+	epoll_fd = epoll_create1(0);
+	wake_fd = eventfd(0, EFD_NONBLOCK);
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.fd = listen_fd;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+	ev.data.fd = wake_fd;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+}
+
+inline query_server::~query_server() {
+	for (map<int, connection>::iterator it = connections.begin(); it != connections.end(); it++) close(it->first);
+	close(wake_fd);
+	close(epoll_fd);
+	close(listen_fd);
+	unlink(path.c_str());
+}
+
+inline void query_server::publish(std::shared_ptr<const compact_tree> tree) {
+	std::atomic_store(&current, tree);
+}
+
+inline void query_server::start() {
+	if (!threads.empty()) return;
+	signal(SIGPIPE, SIG_IGN); /*a client that goes away should only close its own connection*/
+	for (int i = 0; i < n_threads; i++) threads.push_back(thread(&query_server::reader, this));
+	threads.push_back(thread(&query_server::event_loop, this));
+	cout << "Serving queries on " << path << endl;
+}
+
+inline void query_server::serve(std::function<std::shared_ptr<const compact_tree>()> rebuild) {
+	signal(SIGHUP, server_signal_handler);
+	signal(SIGINT, server_signal_handler);
+	signal(SIGTERM, server_signal_handler);
+	start();
+	while (1) {
+		int sig = server_signal;
+		if (sig == SIGINT || sig == SIGTERM) break;
+		if (sig == SIGHUP) { /*rebuild with the new capacities while the old tree keeps answering*/
+			server_signal = 0;
+			auto start = high_resolution_clock::now();
+			publish(rebuild());
+			cout << "Rebuilt the seperator tree in " << (double)duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1000000 << " seconds" << endl;
+		}
+		usleep(100000);
+	}
+	{
+		lock_guard<mutex> lock(m);
+		stopping = true;
+	}
+	cv.notify_all();
+	for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+	threads.clear();
+}
+
+inline void query_server::event_loop() {
+	epoll_event events[64];
+	while (!stopping) {
+		int n = epoll_wait(epoll_fd, events, 64, 100);
+		for (int e = 0; e < n; e++) {
+			int fd = events[e].data.fd;
+			if (fd == listen_fd) {
+				int client = accept(listen_fd, NULL, NULL);
+				if (client < 0) continue;
+				fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+				connection& c = connections[client];
+				c.serial = next_serial++;
+				c.busy = false;
+				epoll_event ev;
+				ev.events = EPOLLIN;
+				ev.data.fd = client;
+				epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client, &ev);
+			}
+			else if (fd == wake_fd) { /*pass the finished responses on to their connections*/
+				uint64_t count;
+				while (read(wake_fd, &count, sizeof(count)) > 0) {}
+				deque<batch> finished;
+				{
+					lock_guard<mutex> lock(m);
+					finished.swap(done);
+				}
+				for (size_t f = 0; f < finished.size(); f++) {
+					map<int, connection>::iterator it = connections.find(finished[f].fd);
+					if (it == connections.end() || it->second.serial != finished[f].serial) continue; /*the client went away meanwhile*/
+					connection& c = it->second;
+					const char* bytes = (const char*)finished[f].response.data();
+					c.out.insert(c.out.end(), bytes, bytes + finished[f].response.size() * sizeof(int32_t));
+					c.busy = false;
+					int client = finished[f].fd;
+					if (!send(client, c)) {
+						epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client, NULL);
+						close(client);
+						connections.erase(it);
+						continue;
+					}
+					dispatch(client, c);
+					watch(client, c);
+				}
+			}
+			else {
+				map<int, connection>::iterator it = connections.find(fd);
+				if (it == connections.end()) continue;
+				connection& c = it->second;
+				bool open = true;
+				if (events[e].events & EPOLLOUT) open = send(fd, c);
+				if (open && (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) open = receive(fd, c);
+				if (!open) { /*a reader may still work on a request of it. Its response is dropped by the serial check*/
+					epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+					close(fd);
+					connections.erase(it);
+					continue;
+				}
+				dispatch(fd, c);
+				watch(fd, c);
+			}
+		}
+	}
+}
+
+inline bool query_server::receive(int fd, connection& c) {
+	char buf[65536];
+	ssize_t r;
+	do r = read(fd, buf, sizeof(buf)); /*one read per event. Whatever is left wakes the event loop again*/
+	while (r < 0 && errno == EINTR);
+	if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+	if (r <= 0) return false; /*closed, with or without half a request*/
+	c.in.insert(c.in.end(), buf, buf + r);
+	uint32_t count;
+	if (c.in.size() >= sizeof(count)) {
+		memcpy(&count, c.in.data(), sizeof(count));
+		if (count > (1u << 24)) return false;
+	}
+	return true;
+}
+
+inline bool query_server::send(int fd, connection& c) {
+	size_t sent = 0;
+	while (sent < c.out.size()) {
+		ssize_t r = write(fd, c.out.data() + sent, c.out.size() - sent);
+		if (r > 0) sent += r;
+		else if (r < 0 && errno == EINTR) continue;
+		else if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		else return false;
+	}
+	c.out.erase(c.out.begin(), c.out.begin() + sent);
+	return true;
+}
+
+inline void query_server::dispatch(int fd, connection& c) {
+	uint32_t count;
+	if (c.busy || c.in.size() < sizeof(count)) return;
+	memcpy(&count, c.in.data(), sizeof(count));
+	size_t bytes = sizeof(uint32_t) + 3 * (size_t)count * sizeof(uint32_t);
+	if (c.in.size() < bytes) return; /*wait for the rest of the request*/
+	batch b;
+	b.fd = fd;
+	b.serial = c.serial;
+	b.request.resize(3 * (size_t)count);
+	if (count > 0) memcpy(&b.request[0], c.in.data() + sizeof(uint32_t), b.request.size() * sizeof(uint32_t));
+	c.in.erase(c.in.begin(), c.in.begin() + bytes);
+	c.busy = true;
+	{
+		lock_guard<mutex> lock(m);
+		ready.push_back(std::move(b));
+	}
+	cv.notify_one();
+}
+
+inline void query_server::watch(int fd, const connection& c) {
+	epoll_event ev;
+	ev.events = 0;
+	if (!c.busy && c.out.empty()) ev.events |= EPOLLIN; /*a client that does not read its responses is not read from either*/
+	if (!c.out.empty()) ev.events |= EPOLLOUT;
+	ev.data.fd = fd;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+inline void query_server::reader() {
+	while (1) {
+		batch b;
+		{
+			unique_lock<mutex> lock(m);
+			cv.wait(lock, [this] { return stopping || !ready.empty(); });
+			if (stopping) return;
+			b = std::move(ready.front());
+			ready.pop_front();
+		}
+		answer(b);
+		{
+			lock_guard<mutex> lock(m);
+			done.push_back(std::move(b));
+		}
+		uint64_t one = 1;
+		if (write(wake_fd, &one, sizeof(one)) < 0) {} /*the counter only has to be non zero*/
+	}
+}
+
+inline void query_server::answer(batch& b) {
+	uint32_t count = b.request.size() / 3;
+	std::shared_ptr<const compact_tree> tree = std::atomic_load(&current); /*the tree this whole batch is answered from*/
+	b.response.resize(count + 1);
+	b.response[0] = (int32_t)count;
+	for (uint32_t q = 0; q < count; q++) {
+		uint32_t op = b.request[3 * q], i = b.request[3 * q + 1], j = b.request[3 * q + 2];
+		if (!tree || i < 1 || j < 1 || i > tree->size() || j > tree->size()) b.response[q + 1] = -1;
+		else if (op == OP_MIN_CUT) b.response[q + 1] = tree->path_min(i - 1, j - 1);
+		else if (op == OP_CUT_SIDE) b.response[q + 1] = (i == j) ? -1 : (int32_t)tree->path_min_node(i - 1, j - 1) + 1;
+		else b.response[q + 1] = -1;
+	}
+}
+
+inline shard_writer::shard_writer(size_t n, const string& dir, size_t shard_nodes, size_t budget)
+	: dir(dir), n(n), shard_nodes(shard_nodes), budget(budget), n_edges(0), buffered(0), buckets((n + shard_nodes - 1) / shard_nodes) {
+	mkdir(dir.c_str(), 0700);
+	for (size_t k = 0; k < buckets.size(); k++) remove(bucket(k).c_str()); /*left over from a run that did not finish*/
+}
+
+inline void shard_writer::add_edge(vertex_d u, vertex_d v, int value) {
+	record from_u = { (uint32_t)u, (uint32_t)v, (int32_t)value }, from_v = { (uint32_t)v, (uint32_t)u, (int32_t)value };
+	buckets[u / shard_nodes].push_back(from_u);
+	buckets[v / shard_nodes].push_back(from_v);
+	n_edges++;
+	buffered += 2 * sizeof(record);
+	if (buffered > budget) flush();
+}
+
+inline string shard_writer::bucket(size_t k) const {
+	return dir + "/bucket_" + to_string(k) + ".bin";
+}
+
+inline void shard_writer::flush() {
+	for (size_t k = 0; k < buckets.size(); k++) {
+		if (buckets[k].empty()) continue;
+		FILE* out = fopen(bucket(k).c_str(), "ab");
+		if (out == NULL || fwrite(buckets[k].data(), sizeof(record), buckets[k].size(), out) != buckets[k].size()) {
+			cerr << "could not write bucket " << bucket(k) << endl;
+			exit(1);
+		}
+		fclose(out);
+		vector<record>().swap(buckets[k]);
+	}
+	buffered = 0;
+}
+
+inline void shard_writer::finish() {
+	for (size_t k = 0; k < buckets.size(); k++) {
+		vertex_d from = k * shard_nodes, to = min(n, (k + 1) * shard_nodes);
+		vector<record> records;
+		FILE* in = fopen(bucket(k).c_str(), "rb");
+		if (in != NULL) { /*what was flushed comes before what is still in memory*/
+			fseek(in, 0, SEEK_END);
+			records.resize(ftell(in) / sizeof(record));
+			fseek(in, 0, SEEK_SET);
+			if (fread(records.data(), sizeof(record), records.size(), in) != records.size()) {
+				cerr << "could not read bucket " << bucket(k) << endl;
+				exit(1);
+			}
+			fclose(in);
+			remove(bucket(k).c_str());
+		}
+		records.insert(records.end(), buckets[k].begin(), buckets[k].end());
+		vector<record>().swap(buckets[k]);
+		/*a counting sort by source keeps the edges of every node in the order they were added*/
+		shard_graph::shard block;
+		block.offsets.assign(to - from + 1, 0);
+		for (size_t r = 0; r < records.size(); r++) block.offsets[records[r].source - from + 1]++;
+		for (size_t i = 0; i < to - from; i++) block.offsets[i + 1] += block.offsets[i];
+		block.entries.resize(records.size());
+		vector<uint64_t> next(block.offsets.begin(), block.offsets.end() - 1);
+		for (size_t r = 0; r < records.size(); r++) {
+			shard_graph::adj_entry e = { records[r].target, records[r].value };
+			block.entries[next[records[r].source - from]++] = e;
+		}
+		string file = dir + "/shard_" + to_string(k) + ".bin";
+		FILE* out = fopen(file.c_str(), "wb");
+		if (out == NULL) {
+			cerr << "could not write shard " << file << endl;
+			exit(1);
+		}
+		fwrite(block.offsets.data(), sizeof(uint64_t), block.offsets.size(), out);
+		fwrite(block.entries.data(), sizeof(shard_graph::adj_entry), block.entries.size(), out);
+		fclose(out);
+	}
+	buffered = 0;
+}
+
+inline shard_graph::shard_graph(shard_writer& writer)
+	: dir(writer.dir), n(writer.n), shard_nodes(writer.shard_nodes), budget(writer.budget), on_disk(0), used(0), peak(0), n_loads(0) {
+	writer.finish();
+	struct stat info;
+	for (size_t k = 0; k * shard_nodes < n; k++) {
+		if (stat(file(k).c_str(), &info) == 0) on_disk += info.st_size;
+	}
+}
+
+inline shard_graph::session::session(const shard_graph& G) : G(G), outer(shard_graph::open()) {
+	shard_graph::open() = this;
+}
+
+inline shard_graph::session::~session() {
+	shard_graph::open() = outer;
+}
+
+inline shard_graph::~shard_graph() {
+	for (size_t k = 0; k * shard_nodes < n; k++) remove(file(k).c_str());
+	rmdir(dir.c_str());
+}
+
+inline string shard_graph::file(size_t k) const {
+	return dir + "/shard_" + to_string(k) + ".bin";
+}
+
+inline std::shared_ptr<const shard_graph::shard> shard_graph::load(vertex_d v) const {
+	size_t k = v / shard_nodes;
+	session* current = open();
+	if (current == NULL || &current->G != this) return fetch(k);
+	for (size_t h = current->held.size(); h-- > 0;) { /*a cut touches only a few shards, the last one first*/
+		if (current->held[h].first == k) return current->held[h].second;
+	}
+	current->held.push_back(make_pair(k, fetch(k)));
+	return current->held.back().second;
+}
+
+inline std::shared_ptr<const shard_graph::shard> shard_graph::fetch(size_t k) const {
+	lock_guard<mutex> lock(m);
+	map<size_t, list<pair<size_t, std::shared_ptr<const shard>>>::iterator>::iterator it = resident.find(k);
+	if (it != resident.end()) {
+		lru.splice(lru.begin(), lru, it->second); /*most recently used*/
+		return it->second->second;
+	}
+	size_t nodes = min(n, (k + 1) * shard_nodes) - k * shard_nodes;
+	std::shared_ptr<shard> block = std::make_shared<shard>();
+	block->offsets.resize(nodes + 1);
+	FILE* in = fopen(file(k).c_str(), "rb");
+	if (in == NULL || fread(block->offsets.data(), sizeof(uint64_t), nodes + 1, in) != nodes + 1) {
+		cerr << "could not read shard " << file(k) << endl;
+		exit(1);
+	}
+	block->entries.resize(block->offsets[nodes]);
+	if (fread(block->entries.data(), sizeof(adj_entry), block->entries.size(), in) != block->entries.size()) {
+		cerr << "could not read shard " << file(k) << endl;
+		exit(1);
+	}
+	fclose(in);
+	n_loads++;
+	size_t bytes = block->offsets.size() * sizeof(uint64_t) + block->entries.size() * sizeof(adj_entry);
+	while (!lru.empty() && used + bytes > budget) { /*make room by dropping the least recently used shards*/
+		used -= lru.back().second->offsets.size() * sizeof(uint64_t) + lru.back().second->entries.size() * sizeof(adj_entry);
+		resident.erase(lru.back().first);
+		lru.pop_back();
+	}
+	lru.push_front(make_pair(k, std::shared_ptr<const shard>(block)));
+	resident[k] = lru.begin();
+	used += bytes;
+	peak = max(peak, used);
+	return lru.front().second;
+}
+
+/*This function returns the cpus of every NUMA node, read from /sys/devices/system/node/node<k>/cpulist (lists like "0-3,8-11"). It is empty when the system
+does not show its nodes*/
+inline vector<vector<int> > numa_nodes() {
+	vector<vector<int> > nodes;
+	for (int k = 0; k < 1024; k++) {
+		char path[96];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", k);
+		FILE* f = fopen(path, "r");
+		if (f == NULL) continue; /*node numbers may have gaps*/
+		vector<int> cpus;
+		int first, last, c;
+		while (fscanf(f, "%d", &first) == 1) {
+			last = first;
+			c = fgetc(f);
+			if (c == '-') {
+				if (fscanf(f, "%d", &last) != 1) break;
+				c = fgetc(f);
+			}
+			for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+			if (c != ',') break;
+		}
+		fclose(f);
+		if (!cpus.empty()) nodes.push_back(cpus);
+	}
+	return nodes;
+}
+
+/*This function restricts the calling process to cpus. Memory is placed on the NUMA node of the cpu that touches it first, so everything the process allocates
+afterwards stays on the node of these cpus*/
+inline bool pin_to_cpus(const vector<int>& cpus) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (size_t i = 0; i < cpus.size(); i++) {
+		if (cpus[i] < CPU_SETSIZE) CPU_SET(cpus[i], &set);
+	}
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+/*One worker process of build_distributed. It builds its own flow network of G once it runs (after it was pinned with NUMA_PLACEMENT, so the network is in the
+memory of its node) and answers every task (s, t) with their minimum cut: s, t, the value, the number of nodes above s on the side of s and those nodes, which is
+all that the coordinator needs to move the later nodes*/
+template <class DirectionTag>
+static void build_worker(int fd, const Graph& G, const edge_property_map& val, DirectionTag) {
+	flow_network<DirectionTag> network(G, val);
+	size_t n = num_vertices(G);
+	uint32_t task[2];
+	while (read_full(fd, task, sizeof(task)) && task[0] < n) {
+		pair<vector<char>, long long> c = network.cut(task[0], task[1]);
+		vector<uint32_t> msg(4);
+		msg[0] = task[0];
+		msg[1] = task[1];
+		msg[2] = (uint32_t)min(c.second, (long long)INT_MAX);
+		for (vertex_d i = task[0] + 1; i < n; i++) {
+			if (c.first[i]) msg.push_back(i);
+		}
+		msg[3] = msg.size() - 4;
+		if (!write_full(fd, &msg[0], msg.size() * sizeof(uint32_t))) break;
+	}
+	close(fd);
+}
+
+/*This function builds the same tree as gusfield_tree with worker processes. The cut of node s in Gusfield's method only depends on s and its parent t at the
+time the cut is made, so the cuts of the next nodes are computed at once with the parents they have now (a task is the pair s, t), and a coordinator (the calling
+process) applies them in the order of s. A cut whose node got another parent in the meantime, from a cut of a smaller node, is computed again with the new
+parent. Most cuts cut off little, so few cuts are computed twice. The tasks run ahead of the applied cuts by at most a few per worker, which bounds both the
+cuts that may be wasted and the sides that wait to be applied. A worker that dies or sends a message that can not be read whole is dropped, and its task goes
+back to the others*/
+template <class DirectionTag>
+compact_tree build_distributed(const Graph& G, const edge_property_map& val, int workers, DirectionTag, live_tree* live) {
+	size_t n = num_vertices(G);
+	compact_tree tree(n);
+	if (n < 2) return tree;
+	workers = max(1, min(workers, (int)n - 1));
+	vector<int> fds;
+	vector<pid_t> pids;
+#if NUMA_PLACEMENT
+	vector<vector<int> > numa = numa_nodes(); /*worker w runs on node w % numa.size()*/
+#endif
+	fflush(stdout); /*the workers must not write what is still buffered again*/
+	void (*pipe_handler)(int) = signal(SIGPIPE, SIG_IGN); /*a task sent to a worker that died should fail, not end the build*/
+	for (int w = 0; w < workers; w++) {
+		int pair_fd[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair_fd) < 0) break;
+		pid_t pid = fork();
+		if (pid < 0) {
+			close(pair_fd[0]);
+			close(pair_fd[1]);
+			break;
+		}
+		if (pid == 0) {
+			close(pair_fd[0]);
+			for (size_t i = 0; i < fds.size(); i++) close(fds[i]);
+#if NUMA_PLACEMENT
+			if (!numa.empty()) pin_to_cpus(numa[w % numa.size()]); /*before the worker builds its flow network, so the network is placed on its node*/
+#endif
+			build_worker(pair_fd[1], G, val, DirectionTag());
+			_exit(0);
+		}
+		close(pair_fd[1]);
+		fds.push_back(pair_fd[0]);
+		pids.push_back(pid);
+	}
+	if (fds.empty()) {
+		cerr << "could not start the build workers" << endl;
+		exit(1);
+	}
+
+	struct result {
+		vertex_d t;
+		int value;
+		vector<uint32_t> side; /*the nodes above s on the side of s*/
+	};
+	vector<vertex_d> p(n, 0); /*current parent of every node, as in gusfield_tree*/
+	map<vertex_d, result> finished; /*cuts that came back before the cuts of all smaller nodes were applied*/
+	set<vertex_d> redo; /*nodes whose cut has to be computed again with their new parent*/
+	vector<vertex_d> running(fds.size(), 0); /*the node whose cut worker w computes, 0 when it is idle*/
+	vertex_d next = 1, applied = 1; /*the next node that was never given out and the next node whose cut is applied*/
+	if (live != NULL) live->reset(true);
+	size_t window = 8 * fds.size(), cuts = 0, wasted = 0, alive = fds.size();
+	auto drop = [&](size_t w) { /*worker w died or sent a broken message: it gets no more tasks and its node is computed again by another worker*/
+		if (running[w]) redo.insert(running[w]);
+		running[w] = 0;
+		close(fds[w]);
+		waitpid(pids[w], NULL, 0);
+		fds[w] = -1;
+		if (--alive == 0) {
+			cerr << "every build worker failed" << endl;
+			exit(1);
+		}
+	};
+	auto dispatch = [&](size_t w) {
+		vertex_d s;
+		if (!redo.empty()) {
+			s = *redo.begin();
+			redo.erase(redo.begin());
+		}
+		else if (next < n && next < applied + window) s = next++;
+		else return;
+		uint32_t task[2] = { (uint32_t)s, (uint32_t)p[s] };
+		running[w] = s;
+		if (!write_full(fds[w], task, sizeof(task))) {
+			drop(w);
+			return;
+		}
+		cuts++;
+	};
+	for (size_t w = 0; w < fds.size(); w++) {
+		if (fds[w] >= 0) dispatch(w);
+	}
+	vector<pollfd> polled(fds.size());
+	while (applied < n) {
+		for (size_t w = 0; w < fds.size(); w++) {
+			polled[w].fd = running[w] ? fds[w] : -1;
+			polled[w].events = POLLIN;
+			polled[w].revents = 0;
+		}
+		if (poll(&polled[0], polled.size(), -1) < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+		for (size_t w = 0; w < fds.size(); w++) {
+			if (!(polled[w].revents & (POLLIN | POLLHUP))) continue;
+			uint32_t head[4];
+			if (!read_full(fds[w], head, sizeof(head)) || head[0] != running[w] || head[3] >= n) {
+				drop(w);
+				continue;
+			}
+			result r;
+			r.t = head[1];
+			r.value = (int)head[2];
+			r.side.resize(head[3]);
+			if (!r.side.empty() && !read_full(fds[w], &r.side[0], r.side.size() * sizeof(uint32_t))) { /*a truncated side is no cut*/
+				drop(w);
+				continue;
+			}
+			running[w] = 0;
+			vertex_d s = head[0];
+			if (p[s] != r.t) { /*a smaller node moved s already*/
+				wasted++;
+				redo.insert(s);
+				continue;
+			}
+			finished[s] = std::move(r);
+		}
+		while (applied < n) { /*the same steps as gusfield_tree, in the same order*/
+			typename map<vertex_d, result>::iterator it = finished.find(applied);
+			if (it == finished.end()) break;
+			const result& r = it->second;
+			if (p[applied] != r.t) {
+				wasted++;
+				redo.insert(applied);
+				finished.erase(it);
+				break;
+			}
+			tree.attach(applied, r.t, r.value);
+			if (live != NULL) live->settle(applied, r.t, r.value);
+			for (size_t i = 0; i < r.side.size(); i++) {
+				if (p[r.side[i]] == r.t) {
+					p[r.side[i]] = applied;
+					if (live != NULL) live->anchor(r.side[i], applied);
+				}
+			}
+			finished.erase(it);
+			applied++;
+		}
+		for (size_t w = 0; w < fds.size(); w++) {
+			if (fds[w] >= 0 && !running[w]) dispatch(w);
+		}
+	}
+	uint32_t stop[2] = { UINT32_MAX, 0 };
+	for (size_t w = 0; w < fds.size(); w++) {
+		if (fds[w] < 0) continue;
+		write_full(fds[w], stop, sizeof(stop));
+		close(fds[w]);
+		waitpid(pids[w], NULL, 0);
+	}
+	signal(SIGPIPE, pipe_handler);
+	cout << "Distributed build -> " << cuts << " cuts (" << wasted << " computed again) on " << fds.size() << " worker processes";
+#if NUMA_PLACEMENT
+	cout << " over " << min(fds.size(), max(numa.size(), (size_t)1)) << " NUMA nodes";
+#endif
+	cout << endl;
+#if TREE_DELTA_ENCODE
+	tree.encode_deltas();
+#endif
+	return tree;
+}
+
+inline cut_hierarchy::cut_hierarchy(const compact_tree& tree) : n(tree.size()) {
+	vector<vertex_d> order;
+	for (vertex_d v = 1; v < n; v++) order.push_back(v); /*tree edge (v, parent of v)*/
+	stable_sort(order.begin(), order.end(), [&](vertex_d a, vertex_d b) { return tree.value(a) > tree.value(b); });
+	vector<size_t> root(n), cluster(n); /*union-find and the current cluster of every root*/
+	for (vertex_d v = 0; v < n; v++) root[v] = cluster[v] = v;
+	for (size_t i = 0; i < order.size(); i++) {
+		vertex_d v = order[i], p = tree.parent(v);
+		size_t a = v, b = p;
+		while (root[a] != a) a = root[a] = root[root[a]];
+		while (root[b] != b) b = root[b] = root[root[b]];
+		merge m = { tree.value(v), v, p, cluster[a], cluster[b] };
+		root[a] = b;
+		cluster[b] = n + steps.size();
+		steps.push_back(m);
+	}
+}
+
+inline vector<vertex_d> cut_hierarchy::partition(int k) const {
+	vector<size_t> root(n);
+	for (size_t v = 0; v < n; v++) root[v] = v;
+	for (size_t i = 0; i < steps.size() && steps[i].value >= k; i++) { /*every merge down to k*/
+		size_t a = steps[i].u, b = steps[i].v;
+		while (root[a] != a) a = root[a] = root[root[a]];
+		while (root[b] != b) b = root[b] = root[root[b]];
+		root[a] = b;
+	}
+	vector<vertex_d> group(n), name(n, n);
+	for (size_t v = 0; v < n; v++) {
+		size_t r = v;
+		while (root[r] != r) r = root[r] = root[root[r]];
+		if (name[r] == n) name[r] = v; /*nodes are visited in order, so the first one is the smallest*/
+		group[v] = name[r];
+	}
+	return group;
+}
+
+inline cut_witness::cut_witness(const compact_tree& tree) : n(tree.size()), order(n), pos(n), subtree(n, 1), paths(n) {
+	for (vertex_d v = 1; v < n; v++) paths.link(v, tree.parent(v), tree.value(v)); /*parents have smaller ids than their children, so every node is linked as a leaf*/
+	for (vertex_d v = n; v-- > 1;) subtree[paths.parent(v)] += subtree[v];
+	/*lay the subtrees out one after the other: every child gets the next free place within the range of its parent*/
+	vector<vertex_d> next(n);
+	if (n > 0) next[0] = 1;
+	for (vertex_d v = 1; v < n; v++) {
+		pos[v] = next[paths.parent(v)];
+		next[paths.parent(v)] += subtree[v];
+		next[v] = pos[v] + 1;
+	}
+	for (vertex_d v = 0; v < n; v++) order[pos[v]] = v;
+}
+
+inline pair<cut_witness::span, cut_witness::span> cut_witness::side(vertex_d u, vertex_d v) const {
+	vertex_d w = lightest(u, v);
+	const vertex_d* first = order.data() + pos[w];
+	const vertex_d* last = first + subtree[w];
+	span empty = { last, last };
+	if (pos[u] >= pos[w] && pos[u] < pos[w] + subtree[w]) {
+		span inside = { first, last };
+		return make_pair(inside, empty);
+	}
+	span before = { order.data(), first }, after = { last, order.data() + n }; /*u is outside the subtree, so its side is everything else*/
+	return make_pair(before, after);
+}
+
+inline live_tree::live_tree(size_t n) : n(n), parents(n), values(n), frontier(0), exact(false) {
+	reset();
+}
+
+inline void live_tree::reset() {
+	reset(false);
+}
+
+inline void live_tree::reset(bool exact_values) {
+	for (vertex_d v = 0; v < n; v++) {
+		parents[v].store(0, std::memory_order_relaxed); /*every node hangs below node 0 at first*/
+		values[v].store(INT_MAX, std::memory_order_relaxed);
+	}
+	exact.store(exact_values, std::memory_order_relaxed);
+	frontier.store(n > 0 ? 1 : 0, std::memory_order_release);
+}
+
+inline void live_tree::settle(vertex_d v, vertex_d parent, int value) {
+	parents[v].store(parent, std::memory_order_relaxed);
+	values[v].store(value, std::memory_order_relaxed);
+	frontier.store(v + 1, std::memory_order_release); /*makes the two stores above visible to every reader that sees the new frontier*/
+}
+
+inline void live_tree::anchor(vertex_d v, vertex_d node) {
+	parents[v].store(node, std::memory_order_release); /*node is settled already, so a reader that sees it here sees it settled*/
+}
+
+inline int live_tree::upper_bound(vertex_d u, vertex_d v) const {
+	size_t f = settled();
+	if (!exact.load(std::memory_order_relaxed)) return INT_MAX;
+	vertex_d a = (u < f) ? u : parents[u].load(std::memory_order_acquire), b = (v < f) ? v : parents[v].load(std::memory_order_acquire);
+	if (a == b) return INT_MAX; /*no cut separated them yet*/
+	int bound = path_min(a, b);
+	return (bound < 0) ? INT_MAX : bound; /*-1 if u or v was settled meanwhile and its parent is not visible yet*/
+}
+
+/*A settled pair of an exact build has its final value, which answers both ways. Otherwise only a no can be proven, by an upper bound below k. The values of the
+heuristic engine are not proven, so it never answers*/
+inline int live_tree::at_least(vertex_d u, vertex_d v, int k) const {
+	if (!exact.load(std::memory_order_relaxed)) return -1;
+	int value = path_min(u, v);
+	if (value >= 0) return (value >= k) ? 1 : 0;
+	return (upper_bound(u, v) < k) ? 0 : -1;
+}
+
+inline int live_tree::path_min(vertex_d u, vertex_d v) const {
+	size_t f = settled();
+	if (u >= f || v >= f) return -1;
+	int res = INT_MAX;
+	while (u != v) { /*the same walk as compact_tree::path_min. Every parent of a settled node is settled*/
+		vertex_d& w = (u > v) ? u : v;
+		res = min(res, values[w].load(std::memory_order_relaxed));
+		w = parents[w].load(std::memory_order_relaxed);
+	}
+	return res;
+}
+
+/*This function builds a flow equivalent tree of G with Gusfield's method: n - 1 exact minimum cuts, each between a node s and its current parent t, after
+which the later nodes on the side of s that hang from t move under s. It needs no contractions and works the same way for directed graphs, where every
+cut is the smaller of the two directions*/
+template <class DirectionTag>
+compact_tree gusfield_tree(const Graph& G, const edge_property_map& val, DirectionTag, live_tree* live) {
+	flow_network<DirectionTag> network(G, val);
+	return gusfield_cuts(num_vertices(G), network, live);
+}
+
+/*This function is Gusfield's method on any network of n nodes whose cut(s, t) returns the side of s and the value of an exact minimum cut, like flow_network.
+If live is set every node is published there once its cut is made, with its current parent as the anchor of the nodes that are not settled*/
+template <class CutNetwork>
+compact_tree gusfield_cuts(size_t n, CutNetwork& network, live_tree* live) {
+	compact_tree tree(n);
+	vector<vertex_d> p(n, 0); /*current parent of every node. Parents are always smaller than their children*/
+	if (live != NULL) live->reset(true);
+	for (vertex_d s = 1; s < n; s++) {
+		vertex_d t = p[s];
+		pair<vector<char>, long long> c = network.cut(s, t);
+		tree.attach(s, t, (int)min(c.second, (long long)INT_MAX));
+		if (live != NULL) live->settle(s, t, (int)min(c.second, (long long)INT_MAX));
+		for (vertex_d i = s + 1; i < n; i++) {
+			if (c.first[i] && p[i] == t) {
+				p[i] = s;
+				if (live != NULL) live->anchor(i, s);
+			}
+		}
+	}
+#if TREE_DELTA_ENCODE
+	tree.encode_deltas();
+#endif
+	return tree;
+}
+
+template <class DirectionTag>
+flow_network<DirectionTag>::flow_network(const Graph& G, const edge_property_map& val) : n(num_vertices(G)), split(false), F(num_vertices(G)) {
+	for (vertex_d v = 0; v < n; v++) {
+		if (G[v].capacity > 0) split = true;
+	}
+	if (split) {
+		for (vertex_d v = 0; v < n; v++) add_vertex(F);
+		for (vertex_d v = 0; v < n; v++) add_arcs(in(v), out(v), G[v].capacity > 0 ? G[v].capacity : LLONG_MAX / 4, 0); /*a capacity of 0 means no limit*/
+	}
+	edge_t ei, ei_end;
+	for (tie(ei, ei_end) = edges(G); ei != ei_end; ei++) add_edge_arcs(source(*ei, G), target(*ei, G), val[*ei], DirectionTag());
+}
+
+template <class DirectionTag>
+pair<vector<char>, long long> flow_network<DirectionTag>::cut(vertex_d s, vertex_d t) {
+	return cut(s, t, DirectionTag());
+}
+
+template <class DirectionTag>
+pair<vector<char>, long long> flow_network<DirectionTag>::cut(vertex_d s, vertex_d t, undirected_tag) {
+	vector<char> side;
+	long long value = flow(s, t, side);
+	return make_pair(side, value);
+}
+
+template <class DirectionTag>
+pair<vector<char>, long long> flow_network<DirectionTag>::cut(vertex_d s, vertex_d t, directed_tag) {
+	vector<char> side_st, side_ts;
+	long long st = flow(s, t, side_st), ts = flow(t, s, side_ts);
+	if (st <= ts) return make_pair(side_st, st);
+	for (vertex_d v = 0; v < n; v++) side_ts[v] = !side_ts[v]; /*the side of s is everything that t does not reach*/
+	return make_pair(side_ts, ts);
+}
+
+template <class DirectionTag>
+void flow_network<DirectionTag>::add_edge_arcs(vertex_d u, vertex_d v, long long c, undirected_tag) {
+	add_arcs(out(u), in(v), c, 0);
+	add_arcs(out(v), in(u), c, 0);
+}
+
+template <class DirectionTag>
+void flow_network<DirectionTag>::add_edge_arcs(vertex_d u, vertex_d v, long long c, directed_tag) {
+	add_arcs(out(u), in(v), c, 0);
+}
+
+template <class DirectionTag>
+void flow_network<DirectionTag>::add_arcs(vertex_d u, vertex_d v, long long forward, long long backward) {
+	flow_traits::edge_descriptor a = add_edge(u, v, F).first, b = add_edge(v, u, F).first;
+	put(edge_capacity, F, a, forward);
+	put(edge_capacity, F, b, backward);
+	put(edge_reverse, F, a, b);
+	put(edge_reverse, F, b, a);
+}
+
+template <class DirectionTag>
+long long flow_network<DirectionTag>::flow(vertex_d s, vertex_d t, vector<char>& side) {
+	long long value = push_relabel_max_flow(F, in(s), out(t)); /*the residual capacities are set up again by every call*/
+	vector<char> reached(num_vertices(F), 0);
+	vector<vertex_d> stack(1, in(s));
+	reached[in(s)] = 1;
+	graph_traits<FlowGraph>::out_edge_iterator ei, ei_end;
+	while (!stack.empty()) {
+		vertex_d u = stack.back();
+		stack.pop_back();
+		for (tie(ei, ei_end) = out_edges(u, F); ei != ei_end; ei++) {
+			vertex_d w = target(*ei, F);
+			if (!reached[w] && get(edge_residual_capacity, F, *ei) > 0) {
+				reached[w] = 1;
+				stack.push_back(w);
+			}
+		}
+	}
+	side.assign(n, 0);
+	for (vertex_d v = 0; v < n; v++) side[v] = reached[out(v)]; /*a node whose own arc is cut is on the side of t*/
+	return value;
+}
+
+template <class DirectionTag>
+bool flow_network<DirectionTag>::at_least(vertex_d s, vertex_d t, long long k, vector<char>& side) {
+	return at_least(s, t, k, side, DirectionTag());
+}
+
+template <class DirectionTag>
+bool flow_network<DirectionTag>::at_least(vertex_d s, vertex_d t, long long k, vector<char>& side, undirected_tag) {
+	return bounded_flow(s, t, k, side) >= k;
+}
+
+template <class DirectionTag>
+bool flow_network<DirectionTag>::at_least(vertex_d s, vertex_d t, long long k, vector<char>& side, directed_tag) {
+	if (bounded_flow(s, t, k, side) < k) return false;
+	if (bounded_flow(t, s, k, side) >= k) return true;
+	for (vertex_d v = 0; v < n; v++) side[v] = !side[v]; /*the side of s is everything that t does not reach*/
+	return false;
+}
+
+template <class DirectionTag>
+long long flow_network<DirectionTag>::bounded_flow(vertex_d s, vertex_d t, long long k, vector<char>& side) {
+	graph_traits<FlowGraph>::edge_iterator ai, ai_end;
+	for (tie(ai, ai_end) = edges(F); ai != ai_end; ai++) put(edge_residual_capacity, F, *ai, get(edge_capacity, F, *ai));
+	long long value = 0;
+	vector<char> reached(num_vertices(F));
+	vector<flow_traits::edge_descriptor> pred(num_vertices(F)); /*arc over which every node was reached by the last search*/
+	vector<vertex_d> queue;
+	graph_traits<FlowGraph>::out_edge_iterator ei, ei_end;
+	while (1) {
+		/*a breadth first search for a shortest augmenting path in the residual network*/
+		fill(reached.begin(), reached.end(), 0);
+		queue.assign(1, in(s));
+		reached[in(s)] = 1;
+		for (size_t q = 0; q < queue.size() && !reached[out(t)]; q++) {
+			for (tie(ei, ei_end) = out_edges(queue[q], F); ei != ei_end; ei++) {
+				vertex_d w = target(*ei, F);
+				if (!reached[w] && get(edge_residual_capacity, F, *ei) > 0) {
+					reached[w] = 1;
+					pred[w] = *ei;
+					queue.push_back(w);
+				}
+			}
+		}
+		if (!reached[out(t)]) break; /*no more paths: what s reaches is a cut of capacity value < k*/
+		long long push = k - value;
+		for (vertex_d w = out(t); w != in(s); w = source(pred[w], F)) push = min(push, get(edge_residual_capacity, F, pred[w]));
+		for (vertex_d w = out(t); w != in(s); w = source(pred[w], F)) {
+			put(edge_residual_capacity, F, pred[w], get(edge_residual_capacity, F, pred[w]) - push);
+			flow_traits::edge_descriptor r = get(edge_reverse, F, pred[w]);
+			put(edge_residual_capacity, F, r, get(edge_residual_capacity, F, r) + push);
+		}
+		value += push;
+		if (value >= k) return value; /*k units found, the rest of the flow is not needed*/
+	}
+	side.assign(n, 0);
+	for (vertex_d v = 0; v < n; v++) side[v] = reached[out(v)]; /*a node whose own arc is cut is on the side of t*/
+	return value;
+}
+
+/*This function returns a reverse Cuthill-McKee order of the nodes of G (the original id of every new id). In that order the neighboors of a node get ids close
+to its own, so the adjacency lists that a cut walks through are close together in memory*/
+inline vector<vertex_d> locality_order(const Graph& G) {
+	vector<vertex_d> old_id(num_vertices(G));
+	cuthill_mckee_ordering(G, old_id.rbegin(), get(vertex_index, G));
+	return old_id;
+}
+
+/*This function copies G with node old_id[v] renamed to v. The edges are added in the order of G, so every out edge list keeps its order*/
+inline Graph relabel_graph(const Graph& G, const edge_property_map& val, const vector<vertex_d>& old_id) {
+	size_t n = num_vertices(G);
+	vector<vertex_d> new_id(n);
+	for (vertex_d v = 0; v < n; v++) new_id[old_id[v]] = v;
+	Graph R(n);
+	for (vertex_d v = 0; v < n; v++) R[v] = G[old_id[v]];
+	edge_t ei, ei_end;
+	for (tie(ei, ei_end) = edges(G); ei != ei_end; ei++) add_edge(new_id[source(*ei, G)], new_id[target(*ei, G)], EdgeProperty{ val[*ei] }, R);
+	return R;
+}
+
+/*This function keeps the seperator tree of G up to date with a stream of edge updates read from path (the standard input if it is empty), one per line:
+"+ u v c" inserts an edge, "- u v" deletes it and "= u v c" changes its capacity (ids are 1-based like the output). A reader thread timestamps every update.
+A batch holds every update that arrives within STREAM_WINDOW_MS of its first one. After a batch is applied to G the tree is either repaired or rebuilt,
+whichever the cost model expects to take less time, and the new version is passed to publish. The stream ends with the input and the last tree is returned.
+
+A repair starts at m, the smallest node that an update of the batch touches. Nodes below m keep their parent and only get their cut computed again, nodes from m
+on are located again like in build_tree. It costs about m cuts plus (N - m) / N of a build, where the time of a cut and of a build are measured. The kept parents
+were chosen on an older G, so once more than STREAM_MAX_DRIFT of the edges changed since the last rebuild the tree is always rebuilt.
+Only the exact heuristic build can be repaired. The other engines, the approximate mode and REORDER_VERTICES always rebuild*/
+inline compact_tree stream_updates(Graph& G, edge_property_map& val, cut_context& ctx, const compact_tree& first, double epsilon, const char* path,
+	std::function<void(std::shared_ptr<const compact_tree>)> publish) {
+	FILE* in = (path[0] == '\0') ? stdin : fopen(path, "r");
+	if (in == NULL) {
+		cout << "The stream " << path << " can not be opened" << endl;
+		return first;
+	}
+	deque<stream_update> pending; /*updates read but not yet in a batch*/
+	bool ended = false;
+	mutex m;
+	condition_variable cv;
+	thread input([&]() {
+		char line[256], op;
+		unsigned long u, v;
+		int value;
+		while (fgets(line, sizeof(line), in) != NULL) {
+			value = 0;
+			int fields = sscanf(line, " %c %lu %lu %d", &op, &u, &v, &value);
+			if (fields < 3 || u == 0 || v == 0 || (op != '-' && fields < 4)) continue; /*not an update*/
+			stream_update up = { op, (vertex_d)(u - 1), (vertex_d)(v - 1), value, high_resolution_clock::now() };
+			lock_guard<mutex> lock(m);
+			pending.push_back(up);
+			cv.notify_one();
+		}
+		lock_guard<mutex> lock(m);
+		ended = true;
+		cv.notify_one();
+	});
+
+	size_t n = num_vertices(G);
+	compact_tree tree = first;
+	bool can_repair = epsilon == 0 && CUT_ENGINE == ENGINE_HEURISTIC && !REORDER_VERTICES;
+	/*the cost model: the time of a whole build and of a single cut. The build is timed at the first rebuild, the cut on a few tree edges now*/
+	double build_time = -1, cut_time = 0;
+	if (ctx.cache != NULL) ctx.cache->invalidate();
+	auto timer = high_resolution_clock::now();
+	vertex_d probes = min((vertex_d)32, n > 0 ? n - 1 : 0);
+	for (vertex_d v = 1; v <= probes; v++) minimum_cut(v, tree.parent(v), val, G, ctx);
+	if (probes > 0) cut_time = (double)duration_cast<microseconds>(high_resolution_clock::now() - timer).count() / probes;
+	size_t drift = 0; /*number of updates since the last rebuild*/
+
+	for (int batch = 1;; batch++) {
+		vector<stream_update> updates;
+		{
+			unique_lock<mutex> lock(m);
+			while (pending.empty() && !ended) cv.wait(lock);
+			if (pending.empty()) break;
+			auto deadline = pending.front().arrived + milliseconds(STREAM_WINDOW_MS);
+			while (!ended && high_resolution_clock::now() < deadline) cv.wait_until(lock, deadline);
+			updates.assign(pending.begin(), pending.end());
+			pending.clear();
+		}
+		auto begin = high_resolution_clock::now();
+		vertex_d low = n; /*smallest node that the batch touches*/
+		size_t ignored = 0;
+		for (size_t q = 0; q < updates.size(); q++) {
+			stream_update& up = updates[q];
+			if (up.u >= n || up.v >= n || up.u == up.v) {
+				ignored++;
+				continue;
+			}
+			pair<edge_d, bool> e = edge(up.u, up.v, G);
+			if (up.op == '+' && !e.second) add_edge(up.u, up.v, EdgeProperty{ up.value }, G);
+			else if ((up.op == '+' || up.op == '=') && e.second) val[e.first] = up.value;
+			else if (up.op == '-' && e.second) remove_edge(up.u, up.v, G);
+			else {
+				ignored++;
+				continue;
+			}
+			low = min(low, min(up.u, up.v));
+		}
+		if (low == n) {
+			cout << "Batch " << batch << " -> " << updates.size() << " updates, " << ignored << " ignored, the tree is unchanged" << endl;
+			continue;
+		}
+		drift += updates.size() - ignored;
+		if (ctx.cache != NULL) ctx.cache->invalidate(); /*the cached cuts belong to the old G*/
+
+		vertex_d keep = max(low, (vertex_d)1); /*nodes 1 to keep - 1 keep their parent*/
+		double repair_time = keep * cut_time + (build_time < 0 ? 0 : build_time * (n - keep) / n);
+		bool repair = can_repair && build_time >= 0 && repair_time < build_time && drift <= STREAM_MAX_DRIFT * num_edges(G);
+		auto built = high_resolution_clock::now();
+		if (repair) tree = build_tree(G, val, ctx, &tree, keep);
+		else {
+			tree = build_seperator_tree(G, val, ctx, epsilon);
+			build_time = (double)duration_cast<microseconds>(high_resolution_clock::now() - built).count();
+			drift = 0;
+		}
+		double build_ms = (double)duration_cast<microseconds>(high_resolution_clock::now() - built).count() / 1000;
+		publish(std::make_shared<const compact_tree>(tree));
+		auto done = high_resolution_clock::now();
+		cout << "Batch " << batch << " -> " << updates.size() << " updates, " << ignored << " ignored, ";
+		if (repair) cout << "repaired from node " << keep + 1;
+		else cout << "rebuilt";
+		cout << " in " << build_ms << " ms, latency " << (double)duration_cast<microseconds>(done - updates.front().arrived).count() / 1000 << " ms (oldest update to publication), "
+			<< (double)duration_cast<microseconds>(done - begin).count() / 1000 << " ms after the window closed" << endl;
+	}
+	input.join();
+	if (in != stdin) fclose(in);
+	return tree;
+}
+
+inline trace_log::trace_log() : origin(high_resolution_clock::now()) {}
+
+inline trace_log& trace_log::get() {
+	static trace_log log;
+	return log;
+}
+
+inline trace_log::thread_events& trace_log::local() {
+	static thread_local thread_events* mine = NULL;
+	if (mine == NULL) {
+		lock_guard<mutex> lock(m);
+		threads.push_back(thread_events());
+		mine = &threads.back();
+		mine->tid = threads.size();
+	}
+	return *mine;
+}
+
+inline long long trace_log::now() const {
+	return duration_cast<microseconds>(high_resolution_clock::now() - origin).count();
+}
+
+inline void trace_log::add(const event& e) {
+	local().events.push_back(e);
+}
+
+inline void trace_log::write(const char* path, trace_format format) const {
+	lock_guard<mutex> lock(m);
+	FILE* out = fopen(path, "w");
+	if (out == NULL) {
+		cout << "The trace file " << path << " can not be opened" << endl;
+		return;
+	}
+	if (format == TRACE_CHROME) {
+		fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+		bool first = true;
+		for (deque<thread_events>::const_iterator t = threads.begin(); t != threads.end(); t++) {
+			for (size_t i = 0; i < t->events.size(); i++) {
+				const event& e = t->events[i];
+				fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%lld,\"dur\":%lld", first ? "" : ",", e.name, (int)getpid(), t->tid, e.start, e.duration);
+				if (e.arg >= 0) fprintf(out, ",\"args\":{\"node\":%lld}", e.arg + 1); /*1-based like the rest of the output*/
+				fprintf(out, "}");
+				first = false;
+			}
+		}
+		fprintf(out, "\n]}\n");
+	}
+	else {
+		map<string, long long> folded; /*self time of every call stack*/
+		for (deque<thread_events>::const_iterator t = threads.begin(); t != threads.end(); t++) {
+			/*backwards a scope comes right before the scopes inside it, so the scope of depth d - 1 seen last encloses the event of depth d*/
+			vector<string> stack; /*stack[d] is the call stack of the enclosing scope of depth d*/
+			char tid[32];
+			snprintf(tid, sizeof(tid), "thread %d", t->tid);
+			for (size_t i = t->events.size(); i-- > 0;) {
+				const event& e = t->events[i];
+				stack.resize(e.depth + 1);
+				stack[e.depth] = (e.depth > 0 ? stack[e.depth - 1] : string(tid)) + ";" + e.name;
+				folded[stack[e.depth]] += e.self;
+			}
+		}
+		for (map<string, long long>::const_iterator it = folded.begin(); it != folded.end(); it++) fprintf(out, "%s %lld\n", it->first.c_str(), it->second);
+	}
+	fclose(out);
+}
+
+inline void trace_log::summary() const {
+	lock_guard<mutex> lock(m);
+	map<string, pair<size_t, pair<long long, long long> > > phases; /*calls, total and self time of every scope name*/
+	for (deque<thread_events>::const_iterator t = threads.begin(); t != threads.end(); t++) {
+		for (size_t i = 0; i < t->events.size(); i++) {
+			pair<size_t, pair<long long, long long> >& p = phases[t->events[i].name];
+			p.first++;
+			p.second.first += t->events[i].duration;
+			p.second.second += t->events[i].self;
+		}
+	}
+	for (map<string, pair<size_t, pair<long long, long long> > >::const_iterator it = phases.begin(); it != phases.end(); it++) {
+		cout << "Phase " << it->first << " -> " << it->second.first << " calls, " << (double)it->second.second.first / 1000 << " ms total, "
+			<< (double)it->second.second.second / 1000 << " ms self" << endl;
+	}
+}
+
+#if TRACE
+inline scoped_timer::scoped_timer(const char* name, long long arg) : name(name), arg(arg), children(0), open(true), outer(innermost()) {
+	depth = outer != NULL ? outer->depth + 1 : 0;
+	innermost() = this;
+	start = trace_log::get().now(); /*last, so the bookkeeping above is not part of the scope*/
+}
+
+inline void scoped_timer::end() {
+	long long stop = trace_log::get().now(); /*first, so the bookkeeping below is not part of the scope*/
+	if (!open) return;
+	open = false;
+	trace_log::event e;
+	e.name = name;
+	e.arg = arg;
+	e.start = start;
+	e.duration = stop - start;
+	e.self = e.duration - children;
+	e.depth = depth;
+	innermost() = outer;
+	trace_log::get().add(e);
+	if (outer != NULL) outer->children += trace_log::get().now() - start; /*with the bookkeeping above, which is no work of the scope around this one either*/
+}
+#endif
+
+/*This function returns the name of the first invariant of a seperator tree of n nodes that tree breaks, or NULL if it keeps them all: it has n nodes, N - 1
+edges (every node but the root 0 has a parent), every node hangs from a smaller node (path_min climbs from the larger node and never ends otherwise) and every
+node is reached from the root. It is checked before any pair is asked*/
+inline const char* broken_invariant(const compact_tree& tree, size_t n) {
+	if (tree.size() != n) return "size";
+	vector<size_t> first(n + 1, 0); /*the children of node v are child[first[v]] to child[first[v + 1] - 1]*/
+	for (vertex_d v = 1; v < n; v++) {
+		if (tree.parent(v) >= n || tree.parent(v) == v) return "edges";
+		first[tree.parent(v) + 1]++;
+	}
+	for (vertex_d v = 1; v < n; v++) {
+		if (tree.parent(v) >= v) return "parent_order";
+	}
+	for (size_t v = 0; v < n; v++) first[v + 1] += first[v];
+	vector<vertex_d> child(n > 0 ? n - 1 : 0);
+	vector<size_t> next(first.begin(), first.end() - 1);
+	for (vertex_d v = 1; v < n; v++) child[next[tree.parent(v)]++] = v;
+	vector<vertex_d> stack;
+	size_t reached = 0;
+	if (n > 0) stack.push_back(0);
+	while (!stack.empty()) {
+		vertex_d v = stack.back();
+		stack.pop_back();
+		reached++;
+		for (size_t c = first[v]; c < first[v + 1]; c++) stack.push_back(child[c]);
+	}
+	if (reached != n) return "connected";
+	return NULL;
+}
+
+/*This function builds the tree of G with the heuristic engine and with every other engine, checks the invariants of every tree (see broken_invariant) and that
+its pair values are symmetric, compares the pair values of every engine with the heuristic and with the exact engine, and appends one line per engine to
+DIFF_REPORT. All pairs are compared up to DIFF_ALL_PAIRS nodes and DIFF_SAMPLES random pairs above that. Up to DIFF_FLOW_PAIRS of them are also checked against
+a maximum flow of the pair in G, which does not depend on any tree. The checksum of the pair values lets reports of two versions of the code be compared when
+both use the same RANDOM_SEED. It returns 1 if a tree breaks an invariant or an exact engine differs from the maximum flows or from gusfield, so that a run of
+the harness can gate a change, and 0 otherwise*/
+inline int differential_report(const Graph& G, const edge_property_map& val, const program_hooks& program) {
+	typedef program_hooks::engine engine;
+	vector<engine> engines;
+	engines.push_back(engine{ "heuristic", [&]() {
+		cut_cache cache;
+		cut_context ctx(num_vertices(G), &cache);
+		return build_tree(G, val, ctx);
+	} });
+	engines.push_back(engine{ "heuristic_uncached", [&]() {
+		cut_context ctx(num_vertices(G));
+		return build_tree(G, val, ctx);
+	} });
+	engines.push_back(engine{ "reordered", [&]() {
+		vector<vertex_d> old_id = locality_order(G);
+		Graph R = relabel_graph(G, val, old_id);
+		cut_cache cache;
+		cut_context ctx(num_vertices(R), &cache);
+		return build_tree(R, get(&EdgeProperty::value, R), ctx, NULL, 0, &old_id);
+	} });
+	engines.push_back(engine{ "workers", [&]() { return build_distributed(G, val, 2, undirected_tag()); }, true });
+	engines.insert(engines.end(), program.engines.begin(), program.engines.end());
+	engines.push_back(engine{ "gusfield", [&]() { return gusfield_tree(G, val, undirected_tag()); }, true });
+	size_t exact = engines.size() - 1;
+
+	size_t n = num_vertices(G);
+	std::mt19937 gen(RANDOM_SEED);
+	vector<pair<vertex_d, vertex_d> > pairs;
+	if (n <= DIFF_ALL_PAIRS) {
+		for (vertex_d i = 0; i < n; i++) {
+			for (vertex_d j = i + 1; j < n; j++) pairs.push_back(make_pair(i, j));
+		}
+	}
+	else {
+		while (pairs.size() < DIFF_SAMPLES) {
+			vertex_d i = gen() % n, j = gen() % n;
+			if (i != j) pairs.push_back(make_pair(i, j));
+		}
+	}
+
+	/*the maximum flows of the checked pairs, with the index of each pair in pairs*/
+	vector<pair<size_t, long long> > flows;
+	flow_network<undirected_tag> net(G, val);
+	for (size_t k = 0; k < pairs.size() && k < DIFF_FLOW_PAIRS; k++) {
+		size_t q = pairs.size() <= DIFF_FLOW_PAIRS ? k : gen() % pairs.size();
+		flows.push_back(make_pair(q, net.cut(pairs[q].first, pairs[q].second).second));
+	}
+
+	vector<vector<int> > values(engines.size());
+	vector<double> ms(engines.size());
+	vector<const char*> broken(engines.size());
+	for (size_t e = 0; e < engines.size(); e++) {
+		auto begin = high_resolution_clock::now();
+		compact_tree tree = engines[e].build();
+		ms[e] = (double)duration_cast<microseconds>(high_resolution_clock::now() - begin).count() / 1000;
+		broken[e] = broken_invariant(tree, n);
+		for (size_t q = 0; q < pairs.size() && broken[e] == NULL; q++) { /*a broken tree is not asked, path_min might not end on it*/
+			values[e].push_back(tree.path_min(pairs[q].first, pairs[q].second));
+			if (values[e].back() != tree.path_min(pairs[q].second, pairs[q].first)) broken[e] = "symmetric";
+		}
+		if (broken[e] != NULL) values[e].clear();
+	}
+
+	FILE* report = fopen(DIFF_REPORT, "a");
+	if (report == NULL) cout << "The report " << DIFF_REPORT << " can not be opened, it is only shown here" << endl;
+	int failed = 0;
+	for (size_t e = 0; e < engines.size(); e++) {
+		size_t differ_heuristic = 0, differ_exact = 0, differ_flow = 0;
+		unsigned long long checksum = 14695981039346656037ULL; /*FNV-1a over the pair values*/
+		for (size_t q = 0; q < values[e].size(); q++) {
+			if (q < values[0].size() && values[e][q] != values[0][q]) differ_heuristic++;
+			if (q < values[exact].size() && values[e][q] != values[exact][q]) differ_exact++;
+			checksum = (checksum ^ (unsigned int)values[e][q]) * 1099511628211ULL;
+		}
+		for (size_t k = 0; k < flows.size() && !values[e].empty(); k++) {
+			if (values[e][flows[k].first] != flows[k].second) differ_flow++;
+		}
+		bool ok = broken[e] == NULL && (!engines[e].exact || (differ_exact == 0 && differ_flow == 0));
+		if (!ok) failed = 1;
+		char line[512];
+		snprintf(line, sizeof(line), "program=%s seed=%d nodes=%zu edges=%zu engine=%s ms=%.3f speedup=%.2f pairs=%zu differ_heuristic=%zu differ_exact=%zu flow_pairs=%zu differ_flow=%zu invariants=%s status=%s checksum=%016llx",
+			program.name, RANDOM_SEED, n, (size_t)num_edges(G), engines[e].name, ms[e], ms[e] > 0 ? ms[0] / ms[e] : 0.0, pairs.size(), differ_heuristic, differ_exact,
+			flows.size(), differ_flow, broken[e] == NULL ? "ok" : broken[e], ok ? "ok" : "FAILED", checksum);
+		cout << line << endl;
+		if (report != NULL) fprintf(report, "%s\n", line);
+	}
+	if (report != NULL) fclose(report);
+	return failed;
+}
+
+/*This function adds a whole edge list to G at once. The out edge list of every node is sized to its final degree first, so each one is allocated once instead of
+growing edge by edge. The edges are added in the order of the list, which keeps the edge order (and so the capacities that init gives) of adding them one by one.
+The list has to hold every edge once: the generators make sure of that as they draw (Random through the drawn slots of both ends, the mesh has no repeats), so
+the list is neither sorted nor de-duplicated here. A sorted list would change the edge order and so the capacities of a seed, and G can not be built as one
+CSR allocation, since it is a Boost adjacency_list that every engine uses, with an out edge vector per node and a list node per edge*/
+inline void add_edges_bulk(Graph& G, const vector<pair<vertex_d, vertex_d> >& edge_list) {
+	vector<size_t> degree(num_vertices(G), 0);
+	for (size_t e = 0; e < edge_list.size(); e++) {
+		degree[edge_list[e].first]++;
+		degree[edge_list[e].second]++;
+	}
+	for (vertex_d v = 0; v < num_vertices(G); v++) G.out_edge_list(v).reserve(G.out_edge_list(v).size() + degree[v]);
+	for (size_t e = 0; e < edge_list.size(); e++) add_edge(edge_list[e].first, edge_list[e].second, G);
+}
+
+/*This function does everything that follows the generation of G: the mode chosen by the knobs (the differential harness, the global minimum cut or the build
+of the seperator tree), the output, the reports and the stream and server modes. run is the scope of the whole run, which ends before the trace is written*/
+inline int run_all_pairs(Graph& G, edge_property_map& value_map, const program_hooks& program, int argc, char* argv[], scoped_timer& run) {
+	/*initialization of clock using chrono library*/
+	auto start = high_resolution_clock::now();
+	auto stop = high_resolution_clock::now();
+	auto duration = duration_cast<microseconds>(stop - start);
+	/*end of timer initialization*/
+#if VERTEX_CAPACITIES
+	for (vertex_d v = 0; v < num_vertices(G); v++) G[v].capacity = rand() % COST_GEN_RANGE + 1;
+#endif
+#if DIFF_HARNESS
+	return differential_report(G, value_map, program); /*the engines are compared on this graph instead of the usual run*/
+#endif
+#if GLOBAL_CUT_ONLY
+	/*only the global minimum cut is needed. With GLOBAL_NAGAMOCHI_IBARAKI that takes a small part of the time of the heuristic tree, the Stoer-Wagner of the boost library takes longer than the tree*/
+	start = high_resolution_clock::now();
+	pair<vector<vertex_d>, int> global_cut = global_minimum_cut(G, value_map, GLOBAL_CUT_METHOD);
+	stop = high_resolution_clock::now();
+	duration = duration_cast<microseconds>(stop - start);
+	cout << "Global minimum cut -> " << global_cut.second << " (" << global_cut.first.size() << " nodes on one side)" << endl;
+	cout << "Total time -> " << (double)duration.count() / 1000000 << " seconds" << endl;
+	return 0;
+#endif
+	double epsilon = (argc > 1) ? atof(argv[1]) : APPROX_EPSILON; /*error that the approximate mode may make. 0 for the exact tree*/
+	cut_cache cache; /*the cuts of tree edges are asked for by every later locate*/
+	cut_context ctx(num_vertices(G), &cache); /*scratch state for the cuts of this build*/
+	live_readers readers(num_vertices(G), ctx); /*the threads that query the tree while it is built*/
+	threshold_reader thresholds(G, value_map, epsilon > 0 ? NULL : &readers.tree()); /*the thread that asks threshold pairs while the tree is built. A sparsified tree proves nothing about G*/
+	start = high_resolution_clock::now(); /*clock begins counting*/
+	scoped_timer build("build");
+	compact_tree tree = build_seperator_tree(G, value_map, ctx, epsilon); /*the seperator tree T: the parent and the minimum cut value of every node*/
+	readers.stop();
+	build.end();
+	scoped_timer output("output");
+	write_results(tree);
+	output.end();
+	stop = high_resolution_clock::now(); /*stop clock counting*/
+	duration = duration_cast<microseconds>(stop - start); /*return the total time*/
+	report_build((double)duration.count() / 1000000, cache, tree);
+	readers.report(tree);
+	if (epsilon > 0) report_approximation(tree, G, value_map, epsilon);
+	thresholds.stop();
+	thresholds.report();
+	finish_trace(run);
+#if SERVER_MODE
+	query_server server(SERVER_SOCKET);
+	server.publish(std::make_shared<const compact_tree>(tree));
+#endif
+#if STREAM_MODE && SERVER_MODE
+	server.start(); /*the server answers from every version of the tree that the stream publishes*/
+	tree = stream_updates(G, value_map, ctx, tree, epsilon, STREAM_INPUT, [&](std::shared_ptr<const compact_tree> next) { server.publish(next); });
+#elif STREAM_MODE
+	tree = stream_updates(G, value_map, ctx, tree, epsilon, STREAM_INPUT, [](std::shared_ptr<const compact_tree>) {}); /*without the server nobody asks the versions in between*/
+#endif
+
+#if SERVER_MODE
+	server.serve([&]() {
+		if (program.redraw) program.redraw(); /*draw new capacities*/
+		cache.invalidate(); /*the cached cuts belong to the old capacities*/
+		return std::make_shared<const compact_tree>(build_seperator_tree(G, value_map, ctx, epsilon));
+	});
+#endif
+	return 0;
+}
+
+/*This function is run_all_pairs for a graph that is not a Graph: the shard_graph of the out of core mode or the grid_mesh of gridG. Only the build (see
+build_seperator_tree), the output, the live readers, the trace and the server run on it. The other modes need G in memory*/
+template <class GraphT, class ValueMap>
+int run_all_pairs(const GraphT& G, const ValueMap& value_map, const program_hooks& program, int argc, char* argv[], scoped_timer& run) {
+	/*initialization of clock using chrono library*/
+	auto start = high_resolution_clock::now();
+	auto stop = high_resolution_clock::now();
+	auto duration = duration_cast<microseconds>(stop - start);
+	/*end of timer initialization*/
+	if (DIFF_HARNESS || GLOBAL_CUT_ONLY || STREAM_MODE || THRESHOLD_QUERIES > 0) cout << "The differential harness, the global minimum cut, the stream mode and the threshold queries need G in memory and are skipped" << endl;
+	if (((argc > 1) ? atof(argv[1]) : APPROX_EPSILON) > 0) cout << "The approximate mode needs G in memory, the exact tree is built" << endl;
+	cut_cache cache; /*the cuts of tree edges are asked for by every later locate*/
+	cut_context ctx(num_vertices(G), &cache); /*scratch state for the cuts of this build*/
+	live_readers readers(num_vertices(G), ctx); /*the threads that query the tree while it is built*/
+	start = high_resolution_clock::now(); /*clock begins counting*/
+	scoped_timer build("build");
+	compact_tree tree = build_seperator_tree(G, value_map, ctx); /*the seperator tree T: the parent and the minimum cut value of every node*/
+	readers.stop();
+	build.end();
+	scoped_timer output("output");
+	write_results(tree);
+	output.end();
+	stop = high_resolution_clock::now(); /*stop clock counting*/
+	duration = duration_cast<microseconds>(stop - start); /*return the total time*/
+	report_build((double)duration.count() / 1000000, cache, tree);
+	readers.report(tree);
+	report_graph(G);
+	finish_trace(run);
+#if SERVER_MODE
+	query_server server(SERVER_SOCKET);
+	server.publish(std::make_shared<const compact_tree>(tree));
+	server.serve([&]() {
+		cache.invalidate();
+		return std::make_shared<const compact_tree>(build_seperator_tree(G, value_map, ctx)); /*the capacities of G stay the same*/
+	});
+#endif
+	return 0;
+}
+
+/*This function builds the seperator tree of a graph that is not a Graph. Only the heuristic engine runs on it, unless the graph has an overload of its own*/
+template <class GraphT, class ValueMap>
+compact_tree build_seperator_tree(const GraphT& G, const ValueMap& value_map, cut_context& ctx) {
+	return build_tree(G, value_map, ctx);
+}
+
+/*This function writes what the knobs ask for of the finished tree to OUTPUT_FILE (or the screen if it is empty): with PRINT_RESULTS the seperator tree and
+all pairs minimum cuts, with PRINT_CLUSTERS the clustering, with CLUSTER_THRESHOLD the groups at that threshold and with PRINT_WITNESSES the cut sides of random pairs*/
+inline void write_results(const compact_tree& tree) {
+#if PRINT_RESULTS || PRINT_CLUSTERS || CLUSTER_THRESHOLD > 0 || PRINT_WITNESSES > 0
+	result_writer writer(OUTPUT_FORMAT, OUTPUT_FILE, OUTPUT_COMPRESS);
+#endif
+#if PRINT_RESULTS
+	writer.message("FOR SEPERATOR TREE");
+	for (vertex_d v = 1; v < tree.size(); v++) {
+		writer.tree_edge(v, tree.parent(v), tree.value(v));
+	}
+
+	for (vertex_d i = 0; i < tree.size(); i++) {
+		for (vertex_d j = i; j < tree.size(); j++) {
+			if (i != j) writer.pair_value(i, j, tree.path_min(i, j)); /*the minimum cut of a pair is the smallest edge on their path within the seperator tree*/
+		}
+	}
+#endif
+#if PRINT_CLUSTERS || CLUSTER_THRESHOLD > 0
+	cut_hierarchy hierarchy(tree); /*the tree edges are sorted once for the whole hierarchy*/
+#endif
+#if PRINT_CLUSTERS
+	writer.message("FOR CLUSTER HIERARCHY (clusters 1 to N are the nodes, cluster N + m is made by the m-th merge)");
+	for (size_t m = 0; m < hierarchy.merges().size(); m++) {
+		writer.cluster_merge(hierarchy.merges()[m].left, hierarchy.merges()[m].right, hierarchy.merges()[m].value);
+	}
+#endif
+#if CLUSTER_THRESHOLD > 0
+	writer.message("FOR GROUPS AT THRESHOLD");
+	vector<vertex_d> groups = hierarchy.partition(CLUSTER_THRESHOLD);
+	for (vertex_d v = 0; v < groups.size(); v++) writer.group(v, groups[v], CLUSTER_THRESHOLD);
+#endif
+#if PRINT_WITNESSES > 0
+	writer.message("FOR CUT SIDES OF RANDOM PAIRS");
+	cut_witness witness(tree);
+	for (int q = 0; q < PRINT_WITNESSES; q++) {
+		vertex_d i = rand() % tree.size(), j = rand() % tree.size();
+		if (i == j) continue;
+		pair<cut_witness::span, cut_witness::span> side = witness.side(i, j);
+		for (vertex_d v : side.first) writer.side(i, j, v);
+		for (vertex_d v : side.second) writer.side(i, j, v);
+	}
+#endif
+#if PRINT_RESULTS || PRINT_CLUSTERS || CLUSTER_THRESHOLD > 0 || PRINT_WITNESSES > 0
+	writer.close(); /*everything has to be written before the total time is printed*/
+#endif
+}
+
+/*This function prints the time of the build and output, the hit rate of the cut cache and the size of the tree*/
+inline void report_build(double seconds, const cut_cache& cache, const compact_tree& tree) {
+	cout << "Total time -> " << seconds << " seconds" << endl; /*print total time in seconds format*/
+	cout << "Cut cache -> " << cache.hits() << " hits, " << cache.misses() << " misses (" << (cache.hits() + cache.misses() ? 100.0 * cache.hits() / (cache.hits() + cache.misses()) : 0.0) << "% hit rate, " << cache.bytes() << " bytes)" << endl;
+	cout << "Seperator tree -> " << tree.size() << " nodes in " << tree.bytes() << " bytes" << endl;
+}
+
+inline threshold_reader::threshold_reader(const Graph& G, const edge_property_map& val, const live_tree* live)
+	: asked(0), yes(0), yes_from_tree(0), no_from_tree(0), differ(0), witness_nodes(0), bounded_us(0), full_us(0) {
+	if (THRESHOLD_QUERIES == 0) return;
+	unsigned int seed = rand(); /*drawn here, since rand is not safe to call while the build may call it*/
+	asker = thread([this, &G, &val, live, seed]() { ask(G, val, live, seed); });
+}
+
+inline void threshold_reader::stop() {
+	if (asker.joinable()) asker.join();
+}
+
+inline void threshold_reader::ask(const Graph& G, const edge_property_map& val, const live_tree* live, unsigned int seed) {
+#if DIRECTED_GRAPH
+	flow_network<directed_tag> net(G, val);
+#else
+	flow_network<undirected_tag> net(G, val);
+#endif
+	std::mt19937 gen(seed);
+	vector<char> side;
+	for (int q = 0; q < THRESHOLD_QUERIES; q++) {
+		vertex_d i = gen() % num_vertices(G), j = gen() % num_vertices(G);
+		if (i == j) continue;
+		asked++;
+		auto begin = high_resolution_clock::now();
+		int proven = (live != NULL) ? live->at_least(i, j, THRESHOLD_K) : -1;
+		bool reaches = (proven == 1);
+		if (proven == 1) yes_from_tree++;
+		else if (proven == 0) no_from_tree++;
+		else {
+			reaches = net.at_least(i, j, THRESHOLD_K, side);
+			if (!reaches) witness_nodes += count(side.begin(), side.end(), 1);
+		}
+		auto middle = high_resolution_clock::now();
+		bounded_us += duration_cast<microseconds>(middle - begin).count();
+		if (reaches) yes++;
+#if THRESHOLD_CHECK
+		long long value = net.cut(i, j).second;
+		full_us += duration_cast<microseconds>(high_resolution_clock::now() - middle).count();
+		if (reaches != (value >= THRESHOLD_K)) differ++;
+#endif
+	}
+}
+
+inline void threshold_reader::report() const {
+	if (THRESHOLD_QUERIES == 0) return;
+	cout << "Threshold queries -> " << asked << " pairs asked for a minimum cut of at least " << THRESHOLD_K << ", " << yes << " yes and " << asked - yes << " no, "
+		<< yes_from_tree + no_from_tree << " of them proven by the tree while it was built (" << yes_from_tree << " yes), " << witness_nodes << " witness nodes in "
+		<< (double)bounded_us / 1000 << " ms";
+	if (THRESHOLD_CHECK) cout << ", checked with " << (double)full_us / 1000 << " ms of full flows, " << differ << " differ";
+	cout << endl;
+}
+
+/*This function ends the scope of the whole run and writes the trace with its summary per phase, when TRACE is set*/
+inline void finish_trace(scoped_timer& run) {
+#if TRACE
+	run.end();
+	trace_log::get().summary();
+	trace_log::get().write(TRACE_FILE, TRACE_FORMAT);
+#endif
+}
+
+inline live_readers::live_readers(size_t n, cut_context& ctx)
+	: live(LIVE_READERS > 0 || THRESHOLD_QUERIES > 0 ? n : 0), ctx(ctx), building(true), answers(LIVE_READERS), bounds(LIVE_READERS), counts(LIVE_READERS, 0), bounded(LIVE_READERS, 0) {
+	if (LIVE_READERS == 0 && THRESHOLD_QUERIES == 0) return;
+	ctx.live = &live;
+	for (int r = 0; r < LIVE_READERS; r++) {
+		threads.push_back(thread([this, r]() {
+			std::mt19937 gen(r + 1);
+			while (building.load(std::memory_order_acquire)) {
+				size_t f = live.settled();
+				if (f < 2) {
+					this_thread::yield();
+					continue;
+				}
+				vertex_d i = gen() % f, j = gen() % f;
+				if (i == j) continue;
+				int value = live.path_min(i, j);
+				if (counts[r]++ < (1 << 16)) answers[r].push_back(make_pair(make_pair(i, j), value));
+				if (f < live.size()) { /*a node that is not settled yet, whose pairs only Gusfield's method bounds*/
+					vertex_d u = f + gen() % (live.size() - f);
+					int bound = live.upper_bound(i, u);
+					if (bound < INT_MAX && bounded[r]++ < (1 << 16)) bounds[r].push_back(make_pair(make_pair(i, u), bound));
+				}
+			}
+		}));
+	}
+}
+
+inline void live_readers::stop() {
+	building.store(false, std::memory_order_release);
+	for (size_t r = 0; r < threads.size(); r++) threads[r].join();
+	threads.clear();
+	if (ctx.live == &live) ctx.live = NULL;
+}
+
+inline void live_readers::report(const compact_tree& tree) const {
+	if (LIVE_READERS == 0) return;
+	size_t answered = 0, checked = 0, differ = 0, bounds_given = 0, above = 0;
+	for (size_t r = 0; r < answers.size(); r++) {
+		answered += counts[r];
+		bounds_given += bounded[r];
+		for (size_t q = 0; q < answers[r].size(); q++) {
+			checked++;
+			if (answers[r][q].second != tree.path_min(answers[r][q].first.first, answers[r][q].first.second)) differ++;
+		}
+		for (size_t q = 0; q < bounds[r].size(); q++) {
+			if (tree.path_min(bounds[r][q].first.first, bounds[r][q].first.second) > bounds[r][q].second) above++;
+		}
+	}
+	cout << "Live queries -> " << answered << " answered by " << LIVE_READERS << " readers during the build, " << differ << " of " << checked << " checked differ from the finished tree, "
+		<< bounds_given << " pairs with a node that was not settled bounded by cut sides, " << above << " finished above their bound" << endl;
+}
+
+#endif
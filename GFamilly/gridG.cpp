@@ -1,67 +1,326 @@
-#include <boost/random/mersenne_twister.hpp>
-#include <boost/random/uniform_real.hpp>
-#include <boost/graph/graph_traits.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/random.hpp>
-#include <vector>
-#include <chrono>
-
-using namespace boost;
-using namespace std;
-using namespace std::chrono;
-
-
+#ifndef COST_GEN_RANGE
 #define COST_GEN_RANGE 10 /*Capacity generator upper limit*/
-/*initialization of nodes for graph*/
+#endif
+#ifndef RANDOM_SEED
+#define RANDOM_SEED (DIFF_HARNESS ? 11 : 0) /*if > 0 the graph and its capacities are drawn with this seed instead of the current time, so that runs can be compared. The differential harness always draws with a fixed seed, so its reports of two versions of the code compare the same graph*/
+#endif
+#ifndef GRID_KERNEL
+#define GRID_KERNEL 0 /*if 1 the mesh is drawn straight into grid_mesh<rows, cols>, which computes the neighboors of a node from its index instead of keeping adjacency lists, and G is never built. ENGINE_GUSFIELD then cuts with the planar dual (see mesh_dual)*/
+#endif
+#ifndef PRINT_RESULTS
+#define PRINT_RESULTS 0 /*if 1 the seperator tree and all pairs minimum cuts are printed after the build*/
+#endif
+
+#include "all_pairs_min_cut.h"
+/*the size of the graph is defined after the include, since Boost uses the same names for template parameters*/
 #define rows 10 /*rows of matrix graph*/
 #define cols 100 /*columns of matrix graph*/
 
-
-struct NodeProperty{
-	int pred;
-	int visited;
+/*grid_mesh is the R x C mesh of init_mat without adjacency lists: node v = r * C + c is joined to v - C, v - 1, v + 1 and v + C when they are inside the mesh,
+and only the capacities of the edges to the right and down are kept. Since R and C are template arguments every index computation is done with constants
+and the out edges come in the same order as in the Graph of init_mat (up, left, right, down), so build_tree gives the same tree on both*/
+template <size_t R, size_t C>
+class grid_mesh {
+public:
+	struct edge_desc {
+		vertex_d source, target;
+		int value;
+	};
+	class out_edge_iterator {
+	public:
+		out_edge_iterator() : mesh(NULL), v(0), k(4) {}
+		out_edge_iterator(const grid_mesh* mesh, vertex_d v, int k) : mesh(mesh), v(v), k(k) { skip(); }
+		edge_desc operator*() const {
+			edge_desc e = { v, 0, 0 };
+			switch (k) {
+			case 0: e.target = v - C; e.value = mesh->down[v - C]; break;
+			case 1: e.target = v - 1; e.value = mesh->right[v - 1]; break;
+			case 2: e.target = v + 1; e.value = mesh->right[v]; break;
+			default: e.target = v + C; e.value = mesh->down[v]; break;
+			}
+			return e;
+		}
+		out_edge_iterator& operator++() { k++; skip(); return *this; }
+		out_edge_iterator operator++(int) { out_edge_iterator old = *this; ++*this; return old; }
+		bool operator==(const out_edge_iterator& o) const { return k == o.k; }
+		bool operator!=(const out_edge_iterator& o) const { return k != o.k; }
+	private:
+		void skip() { /*move to the next direction that stays inside the mesh*/
+			while (k < 4 && !grid_mesh::has(v, k)) k++;
+		}
+		const grid_mesh* mesh;
+		vertex_d v;
+		int k; /*direction: 0 up, 1 left, 2 right, 3 down, 4 past the end*/
+	};
+	/*plays the role of edge_property_map: the capacity travels with the edge descriptor*/
+	struct value_map {
+		int operator[](const edge_desc& e) const { return e.value; }
+	};
+
+	grid_mesh(); /*every capacity is 0 until set_value*/
+	grid_mesh(const Graph& G, const edge_property_map& val); /*takes the capacities of the mesh that init_mat built*/
+	static size_t size() { return R * C; }
+	static bool has(vertex_d v, int k) { /*true if v has a neighboor in direction k*/
+		switch (k) {
+		case 0: return v >= C;
+		case 1: return v % C != 0;
+		case 2: return v % C != C - 1;
+		default: return v + C < R * C;
+		}
+	}
+	int right_value(vertex_d v) const { return right[v]; }
+	int down_value(vertex_d v) const { return down[v]; }
+	void set_value(vertex_d u, vertex_d v, int value) { (v == u + C ? down[u] : right[u]) = value; } /*u < v are neighboors*/
+private:
+	vector<int> right, down; /*capacity of the edge from v to v + 1 and to v + C*/
 };
 
-struct EdgeProperty {
-	int value;
+template <size_t R, size_t C>
+grid_mesh<R, C>::grid_mesh() : right(R * C, 0), down(R * C, 0) {}
+
+template <size_t R, size_t C>
+grid_mesh<R, C>::grid_mesh(const Graph& G, const edge_property_map& val) : right(R * C, 0), down(R * C, 0) {
+	for (vertex_d v = 0; v < R * C; v++) {
+		if (has(v, 2)) right[v] = val[edge(v, v + 1, G).first];
+		if (has(v, 3)) down[v] = val[edge(v, v + C, G).first];
+	}
+}
+
+/*the graph functions of grid_mesh, with the same names and meaning as the Boost functions that minimum_cut and locate call on a Graph*/
+template <size_t R, size_t C>
+inline size_t num_vertices(const grid_mesh<R, C>&) { return R * C; }
+template <size_t R, size_t C>
+inline vertex_d source(const typename grid_mesh<R, C>::edge_desc& e, const grid_mesh<R, C>&) { return e.source; }
+template <size_t R, size_t C>
+inline vertex_d target(const typename grid_mesh<R, C>::edge_desc& e, const grid_mesh<R, C>&) { return e.target; }
+template <size_t R, size_t C>
+inline pair<typename grid_mesh<R, C>::out_edge_iterator, typename grid_mesh<R, C>::out_edge_iterator> out_edges(vertex_d v, const grid_mesh<R, C>& G) {
+	return make_pair(typename grid_mesh<R, C>::out_edge_iterator(&G, v, 0), typename grid_mesh<R, C>::out_edge_iterator(&G, v, 4));
+}
+template <size_t R, size_t C>
+inline size_t out_degree(vertex_d v, const grid_mesh<R, C>&) {
+	return grid_mesh<R, C>::has(v, 0) + grid_mesh<R, C>::has(v, 1) + grid_mesh<R, C>::has(v, 2) + grid_mesh<R, C>::has(v, 3);
+}
+template <size_t R, size_t C>
+inline pair<typename grid_mesh<R, C>::edge_desc, bool> edge(vertex_d u, vertex_d v, const grid_mesh<R, C>& G) {
+	typename grid_mesh<R, C>::edge_desc e = { u, v, 0 };
+	vertex_d low = min(u, v), high = max(u, v);
+	if (high == low + 1 && grid_mesh<R, C>::has(low, 2)) e.value = G.right_value(low);
+	else if (high == low + C && grid_mesh<R, C>::has(low, 3)) e.value = G.down_value(low);
+	else return make_pair(e, false);
+	return make_pair(e, true);
+}
+
+namespace boost {
+	template <size_t R, size_t C> struct graph_traits<grid_mesh<R, C>> {
+		typedef vertex_d vertex_descriptor;
+		typedef typename grid_mesh<R, C>::edge_desc edge_descriptor;
+		typedef typename grid_mesh<R, C>::out_edge_iterator out_edge_iterator;
+		typedef size_t vertices_size_type;
+		typedef size_t degree_size_type;
+	};
+}
+
+/*mesh_dual is the planar dual of a grid_mesh: a face for every cell of the mesh and one outer face, joined across every edge of the mesh with its capacity.
+A minimum cut of s and t is a cycle of the dual around one of them. Every s-t path crosses such a cycle an odd number of times, so with one fixed s-t path P
+(along the row of s, then the column of t) the cut is the lightest closed walk of the dual that crosses P an odd number of times. That is a shortest path
+from (f, even) to (f, odd) where crossing an edge of P flips the parity, and the walk passes a face f next to P. A search is run from one face next to every
+edge of P. The walk is the same backwards with the parity flipped, so a search only has to reach half way: it stops at half the lightest cut found so far,
+which starts at the lighter of the edges around s or t. Later searches skip the faces earlier searches started from, since every walk through them was tried.
+cut gives the same answer as flow_network::cut, so gusfield_cuts runs on it*/
+template <size_t R, size_t C>
+class mesh_dual {
+public:
+	mesh_dual(const grid_mesh<R, C>& mesh);
+	pair<vector<char>, long long> cut(vertex_d s, vertex_d t); /*the side of s and the value of a minimum cut of s and t*/
+private:
+	static const size_t F = (R - 1) * (C - 1) + 1; /*the cells and the outer face, which is the last*/
+	static size_t face(long r, long c) { return (r < 0 || c < 0 || r >= (long)R - 1 || c >= (long)C - 1) ? F - 1 : r * (C - 1) + c; } /*the cell whose top left node is (r, c)*/
+	/*the edges of the mesh are numbered 2v for the edge from v to v + 1 and 2v + 1 for the edge from v to v + C*/
+	size_t other(size_t e, size_t f) const { return sides[e].first == f ? sides[e].second : sides[e].first; }
+	long long around(vertex_d v) const; /*sum of the capacities of the edges of v*/
+	void walk_back(size_t x, size_t f, vector<uint32_t>& edges) const; /*adds the edges the search from f reached state x through*/
+	const grid_mesh<R, C>& mesh;
+	vector<vector<uint32_t> > borders; /*the edges around every face*/
+	vector<pair<size_t, size_t> > sides; /*the two faces of every edge*/
+	vector<int> weight; /*the capacity of every edge*/
+	vector<char> crossing; /*1 for the edges of P while a cut runs*/
+	vector<long long> dist; /*distance of every state 2 * face + parity, LLONG_MAX if not reached*/
+	vector<uint32_t> via; /*the edge every reached state was reached through*/
 };
 
-typedef adjacency_list<vecS, vecS, undirectedS, NodeProperty, EdgeProperty> Graph;
-typedef graph_traits<Graph>::edge_parallel_category disallow_parallel_edge_tag;
-typedef graph_traits<Graph>::vertex_descriptor vertex_d;
-typedef graph_traits<Graph>::edge_descriptor edge_d;
-typedef graph_traits<Graph>::vertex_iterator vertex_t;
-typedef graph_traits<Graph>::edge_iterator edge_t;
-typedef graph_traits<Graph>::out_edge_iterator out_edge_t;
-
-typedef property_map<Graph, int NodeProperty::*>::type node_property_map;
-typedef property_map<Graph, int EdgeProperty::*>::type edge_property_map;
-
-pair<vector<vertex_d>, int> minimum_cut(vertex_d s, vertex_d t, edge_property_map& val, Graph& G);
-vertex_d locate(Graph& sep_subtree, Graph& G, vertex_d p, edge_property_map& mvm, edge_property_map& Gvals);
-vector<vertex_d> comp_cut_set(vector<vertex_d> cut_set, vector<vertex_d> N_set);
-vector<vertex_d> get_set_N(Graph& G);
-void init_mat(Graph& graph, edge_property_map& epm);
+template <size_t R, size_t C>
+mesh_dual<R, C>::mesh_dual(const grid_mesh<R, C>& mesh) : mesh(mesh), borders(F), sides(2 * R * C), weight(2 * R * C, 0), crossing(2 * R * C, 0), dist(2 * F, LLONG_MAX), via(2 * F) {
+	for (vertex_d v = 0; v < R * C; v++) {
+		long r = v / C, c = v % C;
+		if (grid_mesh<R, C>::has(v, 2)) {
+			sides[2 * v] = make_pair(face(r - 1, c), face(r, c)); /*the cells above and below*/
+			weight[2 * v] = mesh.right_value(v);
+		}
+		if (grid_mesh<R, C>::has(v, 3)) {
+			sides[2 * v + 1] = make_pair(face(r, c - 1), face(r, c)); /*the cells left and right*/
+			weight[2 * v + 1] = mesh.down_value(v);
+		}
+		for (size_t e = 2 * v; e < 2 * v + 2; e++) {
+			if (!grid_mesh<R, C>::has(v, e == 2 * v ? 2 : 3)) continue;
+			borders[sides[e].first].push_back(e);
+			if (sides[e].second != sides[e].first) borders[sides[e].second].push_back(e); /*on a mesh of one row or column both sides are the outer face*/
+		}
+	}
+}
 
-int main() {
-	int N = rows*cols; /*N Contains the number of total nodes*/
+template <size_t R, size_t C>
+long long mesh_dual<R, C>::around(vertex_d v) const {
+	long long sum = 0;
+	typename grid_mesh<R, C>::out_edge_iterator ei, ei_end;
+	for (tie(ei, ei_end) = out_edges(v, mesh); ei != ei_end; ei++) sum += (*ei).value;
+	return sum;
+}
 
-	/*initialization of clock using chrono library*/
-	auto start = high_resolution_clock::now(); 
-	auto stop = high_resolution_clock::now();
-	auto duration = duration_cast<microseconds>(stop - start);
-	/*end of timer initialization*/
+template <size_t R, size_t C>
+void mesh_dual<R, C>::walk_back(size_t x, size_t f, vector<uint32_t>& edges) const {
+	while (x != 2 * f) {
+		uint32_t e = via[x];
+		edges.push_back(e);
+		x = 2 * other(e, x / 2) + ((x & 1) ^ crossing[e]);
+	}
+}
 
+template <size_t R, size_t C>
+pair<vector<char>, long long> mesh_dual<R, C>::cut(vertex_d s, vertex_d t) {
+	vector<uint32_t> path; /*P: along the row of s to the column of t, then along that column to t*/
+	for (vertex_d v = s; v % C != t % C; v += (v % C < t % C) ? 1 : -1) path.push_back(2 * min(v, (v % C < t % C) ? v + 1 : v - 1));
+	for (vertex_d v = s - s % C + t % C; v != t; v += (v < t) ? C : -C) path.push_back(2 * min(v, (v < t) ? v + C : v - C) + 1);
+	for (size_t i = 0; i < path.size(); i++) crossing[path[i]] = 1;
+
+	long long best = min(around(s), around(t));
+	vector<uint32_t> cycle; /*the edges of the lightest walk, empty while the edges around s or t are the lightest cut*/
+	vector<char> searched(F, 0); /*faces whose walks were all tried. A lighter walk does not pass them*/
+	vector<size_t> reached;
+	typedef pair<long long, size_t> state;
+	for (size_t i = 0; i < path.size(); i++) {
+		size_t f = sides[path[i]].first;
+		if (searched[f]) continue;
+		priority_queue<state, vector<state>, greater<state> > queue;
+		dist[2 * f] = 0;
+		reached.push_back(2 * f);
+		queue.push(state(0, 2 * f));
+		while (!queue.empty()) {
+			state top = queue.top();
+			queue.pop();
+			if (2 * top.first >= best) break; /*both halves of a lighter walk are below best / 2, so the search has seen them already*/
+			if (top.first > dist[top.second]) continue;
+			size_t g = top.second / 2, parity = top.second & 1;
+			for (size_t k = 0; k < borders[g].size(); k++) {
+				uint32_t e = borders[g][k];
+				size_t h = other(e, g);
+				if (searched[h]) continue;
+				size_t next = 2 * h + (parity ^ crossing[e]), mirror = next ^ 1;
+				long long d = top.first + weight[e];
+				if (dist[mirror] != LLONG_MAX && d + dist[mirror] < best) { /*the walk to next goes on back to f like the walk to mirror, so it ends with odd parity*/
+					best = d + dist[mirror];
+					cycle.clear();
+					walk_back(top.second, f, cycle);
+					cycle.push_back(e);
+					walk_back(mirror, f, cycle);
+				}
+				if (d < dist[next]) {
+					if (dist[next] == LLONG_MAX) reached.push_back(next);
+					dist[next] = d;
+					via[next] = e;
+					queue.push(state(d, next));
+				}
+			}
+		}
+		for (size_t k = 0; k < reached.size(); k++) dist[reached[k]] = LLONG_MAX;
+		reached.clear();
+		searched[f] = 1;
+	}
+	for (size_t i = 0; i < path.size(); i++) crossing[path[i]] = 0;
+
+	vector<char> side(R * C, 0);
+	if (cycle.empty()) { /*the edges around s or t*/
+		if (around(s) <= around(t)) side[s] = 1;
+		else {
+			side.assign(R * C, 1);
+			side[t] = 0;
+		}
+		return make_pair(side, best);
+	}
+	vector<char> removed(2 * R * C, 0);
+	for (size_t i = 0; i < cycle.size(); i++) removed[cycle[i]] = 1;
+	vector<vertex_d> stack(1, s); /*the side of s is what s reaches without the edges of the cycle*/
+	side[s] = 1;
+	while (!stack.empty()) {
+		vertex_d v = stack.back();
+		stack.pop_back();
+		typename grid_mesh<R, C>::out_edge_iterator ei, ei_end;
+		for (tie(ei, ei_end) = out_edges(v, mesh); ei != ei_end; ei++) {
+			vertex_d w = (*ei).target;
+			if (!side[w] && !removed[2 * min(v, w) + (max(v, w) - min(v, w) == C ? 1 : 0)]) {
+				side[w] = 1;
+				stack.push_back(w);
+			}
+		}
+	}
+	return make_pair(side, best);
+}
+
+/*This function builds the seperator tree of the mesh with the engine that was chosen at compile time. ENGINE_GUSFIELD cuts with the planar dual instead of
+maximum flows*/
+template <size_t R, size_t C>
+compact_tree build_seperator_tree(const grid_mesh<R, C>& G, const typename grid_mesh<R, C>::value_map& value_map, cut_context& ctx) {
+#if CUT_ENGINE == ENGINE_GUSFIELD
+	mesh_dual<R, C> dual(G);
+	return gusfield_cuts(G.size(), dual, ctx.live);
+#endif
+	return build_tree(G, value_map, ctx);
+}
+
+template <class AddEdge>
+void mesh_edges(AddEdge add);
+void init_mat(Graph& graph, edge_property_map& epm);
+void init_mat(shard_writer& writer);
+template <size_t R, size_t C>
+void init_mat(grid_mesh<R, C>& mesh);
+
+int main(int argc, char* argv[]) {
+	scoped_timer run("main"); /*the whole run, the scope that holds all others*/
+
+#if OUT_OF_CORE
+	scoped_timer generation("generate");
+	shard_writer writer(rows*cols, OUT_OF_CORE_DIR); /*the edges go straight to the shards on disk, G is never built*/
+	init_mat(writer);
+	shard_graph disk(writer);
+	generation.end();
+
+	cout << "Number of Nodes = " << num_vertices(disk) << endl;
+	cout << "Number of edges = " << writer.edges() << endl;
+
+	program_hooks program = { "grid", std::function<void()>(), {} }; /*the capacities on disk stay the same*/
+	return run_all_pairs(disk, shard_graph::value_map(), program, argc, argv, run);
+#elif GRID_KERNEL
+	scoped_timer generation("generate");
+	grid_mesh<rows, cols> mesh; /*the capacities are drawn straight into the mesh, G is never built*/
+	init_mat(mesh);
+	generation.end();
+
+	cout << "Number of Nodes = " << num_vertices(mesh) << endl;
+	cout << "Number of edges = " << rows * (cols - 1) + (rows - 1) * cols << endl;
+
+	program_hooks program = { "grid", std::function<void()>(), {} }; /*the capacities of the mesh stay the same*/
+	return run_all_pairs(mesh, grid_mesh<rows, cols>::value_map(), program, argc, argv, run);
+#else
 	Graph G(rows*cols); /*create a graph that has N nodes*/
-	Graph seperator_tree(rows*cols); /*create a graph that has N nodes*/
 
 	vertex_t vi,vi_end;
 	
 	edge_property_map value_map = get(&EdgeProperty::value, G); /*value_map holds information about the capacities of graph G*/
 
-	edge_property_map min_value_map = get(&EdgeProperty::value, seperator_tree); /*value_map holds information about the capacities of the seperator tree T*/
 
+	scoped_timer generation("generate");
 	init_mat(G, value_map); /*Function to initialize all capacities of edges and the edges themselves*/
+	generation.end();
 
 	cout << "Number of Nodes = " << num_vertices(G) << endl;
     cout << "Number of edges = " << num_edges(G) << endl;
@@ -72,345 +331,65 @@ int main() {
 	/*for (tie(ei, ei_end) = edges(G); ei != ei_end; ei++) {
 		std::cout << "we got an edge linking nodes " << source(*ei, G) + 1 << " and " << target(*ei, G) + 1 << " with value of " << value_map[*ei] << endl;
 	}*/
-	
-	vertex_d k;
-
-	start = high_resolution_clock::now(); /*clock begins counting*/
-
-	/*This for is the heart of the program. It calls the essential functions locate and minimum_cut that create the seperator tree*/
-	for (int i = 0; i < N; i++) {
-		if (i == 0) continue; /*obviously at the start the seperator tree is considered empty so we simply add the first node in the tree*/
-		else {
-			k = locate(seperator_tree, G, i, min_value_map, value_map);	/*recursively add all nodes in the seperator tree and create their corresponding edges*/
-			min_value_map[edge(i, k, seperator_tree).first] = minimum_cut(i, k, value_map, G).second;  /*Now that the edges are created we update their capacities to be equal to the minimum cut of the start and end nodes*/
-		}
-	}
-	
-
-	/*we use the minimum_cuts variable to describe every edge within the seperator tree. In other words we save the seperator tree within this variable in the form of a vector*/
-	vector<pair<edge_d,int>> minimum_cuts;
-	pair<edge_d, int> result;
-	for (tie(ei, ei_end) = edges(seperator_tree); ei != ei_end; ei++) {
-		result.first = *ei;
-		result.second = min_value_map[*ei];
-		minimum_cuts.push_back(result);
-	}
-
-	/*The comments below are used as a debugging tool to show on screen both the seperator tree and all pairs minimum cuts*/
-
-	/*for (tie(ei, ei_end) = edges(seperator_tree); ei != ei_end; ei++) {
-		std::cout << "there is an edge linking " << source(*ei, seperator_tree) + 1 << " and " << target(*ei, seperator_tree) + 1 << " and has a minimum cut of " << min_value_map[*ei] << endl;
-	}*/
 
-	/*for (int i = 0; i < N; i++) {
-		for (int j = i; j < N; j++) {
-			if (i != j) std::cout << "Pair " << i + 1 << " and " << j + 1 << " has a minimum cut value of " << minimum_cut(i, j, min_value_map, seperator_tree).second << endl;
-		}
-	}*/
-
-	stop = high_resolution_clock::now(); /*stop clock counting*/
-	duration = duration_cast<microseconds>(stop - start); /*return the total time*/
-	cout << "Total time -> " << (double)duration.count() / 1000000 << " seconds" << endl; /*print total time in seconds format*/
-	return 0;
+	program_hooks program = { "grid", [&]() {
+		edge_t ei, ei_end;
+		for (tie(ei, ei_end) = edges(G); ei != ei_end; ei++) value_map[*ei] = rand() % COST_GEN_RANGE + 1; /*draw new capacities*/
+	}, {} };
+	program.engines.push_back(program_hooks::engine{ "grid_mesh", [&]() {
+		grid_mesh<rows, cols> mesh(G, value_map); /*G is always the mesh of init_mat here*/
+		cut_cache cache;
+		cut_context ctx(num_vertices(G), &cache);
+		return build_tree(mesh, grid_mesh<rows, cols>::value_map(), ctx);
+	} });
+	program.engines.push_back(program_hooks::engine{ "grid_mesh_dual", [&]() {
+		grid_mesh<rows, cols> mesh(G, value_map);
+		mesh_dual<rows, cols> dual(mesh);
+		return gusfield_cuts(mesh.size(), dual);
+	}, true });
+	return run_all_pairs(G, value_map, program, argc, argv, run);
+#endif
 }
 
-/*Here we initialize edges of matrix graph and capacities*/
-void init_mat(Graph& graph, edge_property_map& epm) {
+/*This function passes every edge of the matrix graph to add, row by row*/
+template <class AddEdge>
+void mesh_edges(AddEdge add) {
 	int r, c;
 	for (r = 0; r < rows; r++) {
 		for (c = 0; c < cols; c++) {
 			if (c != cols - 1 && r != rows - 1) {
-				add_edge(r * cols + c, r * cols + c + 1, graph);
-				add_edge(r * cols + c, (r + 1) * cols + c, graph);
+				add(r * cols + c, r * cols + c + 1);
+				add(r * cols + c, (r + 1) * cols + c);
 			}
-			else if (c == cols - 1 && r != rows - 1) add_edge(r * cols + c, (r + 1) * cols + c, graph);
-			else if (c != cols - 1 && r == rows - 1) add_edge(r * cols + c, r * cols + c + 1, graph);
+			else if (c == cols - 1 && r != rows - 1) add(r * cols + c, (r + 1) * cols + c);
+			else if (c != cols - 1 && r == rows - 1) add(r * cols + c, r * cols + c + 1);
 		}
 	}
+}
+
+/*Here we initialize edges of matrix graph and capacities*/
+void init_mat(Graph& graph, edge_property_map& epm) {
+	vector<pair<vertex_d, vertex_d> > edge_list; /*the edges of the mesh, added to the graph all at once*/
+	edge_list.reserve(2 * rows * cols);
+	mesh_edges([&](vertex_d u, vertex_d v) { edge_list.push_back(make_pair(u, v)); });
+	add_edges_bulk(graph, edge_list);
 	edge_t ei, ei_end;
-	srand(time(0));
+	srand(RANDOM_SEED > 0 ? RANDOM_SEED : time(0));
 	int i = 0;
 	for (tie(ei, ei_end) = edges(graph); ei != ei_end; ei++,i++) {
 		epm[*ei] = rand() % COST_GEN_RANGE + 1;
 	}
 }
 
-
-
-pair<vector<vertex_d>, int> minimum_cut(vertex_d s, vertex_d t, edge_property_map& val, Graph& G) {
-	out_edge_t ei, ei_end; /*checks for the edges that come out from a specific node*/
-	vertex_t vi, vi_end;
-	node_property_map pred = get(&NodeProperty::pred, G); /*create a predecessor map*/
-	node_property_map visited = get(&NodeProperty::visited, G); /*create a visited map*/
-	int spread = 1; /*spread variable is used as a search limit. If it's 1 it checks for the neighboor nodes of starting node, if it's 2 it checks for the neighboors of the neighboors of the starting node and so on*/
-	visited[s] = 1; /*obviously we mark the node that we start from as visited*/
-	visited[t] = 1; /*we also mark this starting node as visited since we also check for a cut that comes from this node*/
-
-	int min_cut = INT_MAX; /*initialization with the maximum integer*/
-	int sum = 0;
-
-	vector<vertex_d> source_adj, target_adj, cut_set_A; /*these vectors will be used to store information about the neighbooring nodes in the searching process. Cut_set_A is used to store the first set after the cut*/
-
-	vector<vertex_d> temp_source;
-
-	for (tie(ei, ei_end) = out_edges(s, G); ei != ei_end; ei++) { /*for all edges that come out of node s*/
-		if (target(*ei, G) != t) {
-			source_adj.push_back(target(*ei, G)); /*store neighboor nodes*/
-		}
-		sum += val[*ei]; /*store the cost of the cut as the sum of the capacities that are in the cut*/
-	}
-	if (sum < min_cut) { /*store the minimum cut in the first set*/
-		cut_set_A.clear();
-		min_cut = sum;
-		cut_set_A.push_back(s);
-	}
-	vertex_d next_s;
-	int temp = sum;
-	for (int i = 0; i < source_adj.size(); i++) { /*for each neighbooring node*/
-		next_s = source_adj[i]; /*check the other nodes*/
-		pred[next_s] = s;
-		/*initialize the visited of all other nodes as "not visited"*/
-		for (tie(vi, vi_end) = vertices(G); vi != vi_end; vi++) {
-			if (*vi != s && *vi != t) visited[*vi] = 0;
-		}
-		visited[next_s] = 1; /*mark current node as visited*/
-
-		for (int j = 0; j < spread; j++) { /*for each neighboor (if spread = 1 then we only check for current node next_s)*/
-			temp = temp - val[edge(pred[next_s], next_s, G).first]; /*update the cut value correctly*/
-			/*for each neighboor of next_s node*/
-			for (tie(ei, ei_end) = out_edges(next_s, G); ei != ei_end; ei++) {
-
-				if (out_degree(source(*ei, G), G) >= 2) {
-
-					if (visited[target(*ei, G)] == 0) {
-						temp_source.push_back(target(*ei, G));
-					}
-				}
-				else if (out_degree(source(*ei, G), G) == 1) {
-					break;
-				}
-				if (target(*ei, G) != s)temp += val[*ei];
-
-			}
-			if (temp_source.empty()) {
-				break;
-			}
-			pred[*temp_source.begin()] = next_s;
-			next_s = *temp_source.begin();
-			visited[next_s] = 1;
-			/*check if this cut value is minimum and if yes update the cut_set_A variable so that it contains the set of nodes that are cut from graph G*/
-			if (temp < min_cut) {
-				cut_set_A.clear();
-				min_cut = temp;
-				vertex_d prev_s = next_s;
-
-				for (int k = 0; k < temp_source.size(); k++) {
-					cut_set_A.push_back(pred[prev_s]);
-					prev_s = pred[prev_s];
-				}
-				cut_set_A.push_back(s);
-			}
-			temp_source.clear();
-
-		}
-
-		temp = sum;
-	}
-	/*the rest below are exactly the same as with node s but this time for node t instead.*/
-	sum = 0;
-	for (tie(ei, ei_end) = out_edges(t, G); ei != ei_end; ei++) {
-		if (target(*ei, G) != s) {
-			target_adj.push_back(target(*ei, G));
-
-		}
-		sum += val[*ei];
-	}
-
-	if (sum < min_cut) {
-		cut_set_A.clear();
-		min_cut = sum;
-		cut_set_A.push_back(t);
-	}
-	temp = sum;
-	vertex_d next_t;
-	vector<vertex_d> temp_target;
-	for (int i = 0; i < target_adj.size(); i++) {
-		next_t = target_adj[i];
-		pred[next_t] = t;
-
-		for (tie(vi, vi_end) = vertices(G); vi != vi_end; vi++) {
-			if (*vi != s && *vi != t) visited[*vi] = 0;
-		}
-		visited[next_t] = 1;
-
-		for (int j = 0; j < spread; j++) {
-			temp = temp - val[edge(pred[next_t], next_t, G).first];
-
-			for (tie(ei, ei_end) = out_edges(next_t, G); ei != ei_end; ei++) {
-
-				if (out_degree(source(*ei, G), G) >= 2) {
-
-					if (visited[target(*ei, G)] == 0) {
-						temp_target.push_back(target(*ei, G));
-					}
-				}
-				else if (out_degree(source(*ei, G), G) == 1) {
-					break;
-				}
-				if (target(*ei, G) != t)temp += val[*ei];
-
-			}
-			if (temp_target.empty()) {
-				break;
-			}
-
-			pred[*temp_target.begin()] = next_t;
-			next_t = *temp_target.begin();
-			visited[next_t] = 1;
-
-			if (temp < min_cut) {
-				cut_set_A.clear();
-				min_cut = temp;
-				vertex_d prev_t = next_t;
-
-				for (int k = 0; k < temp_target.size(); k++) {
-					cut_set_A.push_back(pred[prev_t]);
-					prev_t = pred[prev_t];
-				}
-				cut_set_A.push_back(t);
-			}
-
-			temp_target.clear();
-
-		}
-
-		temp = sum;
-	}
-
-	/*we create a pair of a vertex vector and and integer that together create the results that are returned by the function*/
-	pair<vector<vertex_d>, int> res;
-	res.first = cut_set_A; /*right now cut_set_A should contain the subset of nodes that are cut from graph G*/
-	res.second = min_cut; /*min_cut should contain the correct value of the minimum cut that occured*/
-	return res;
+/*Here we write the edges of the matrix graph and their capacities to the shards of the out of core mode. The capacities are drawn in the same order as on the graph*/
+void init_mat(shard_writer& writer) {
+	srand(RANDOM_SEED > 0 ? RANDOM_SEED : time(0));
+	mesh_edges([&](vertex_d u, vertex_d v) { writer.add_edge(u, v, rand() % COST_GEN_RANGE + 1); });
 }
 
-/*This function simply returns the whole set of nodes for graph G*/
-vector<vertex_d> get_set_N(Graph& G) {
-	vertex_t vi, vi_end;
-	vector<vertex_d> set;
-	for (tie(vi, vi_end) = vertices(G); vi != vi_end; vi++) set.push_back(*vi);
-	return set;
-}
-/*This function simply returns the subset of the nodes that remained within G after the minimum cut. In other words it creates the complinent subset of cut_set_A that is created within minimum_cut function*/
-vector<vertex_d> comp_cut_set(vector<vertex_d> cut_set, vector<vertex_d> N_set) {
-	vector<vertex_d> comp_set;
-	bool found;
-	for (int i = 0; i < N_set.size(); i++) {
-		found = false;
-		for (int j = 0; j < cut_set.size(); j++) {
-			if (N_set[i] == cut_set[j]) found = true;
-		}
-		if (!found) comp_set.push_back(N_set[i]);
-	}
-	return comp_set;
+/*Here we draw the capacities of the matrix graph straight into the mesh of GRID_KERNEL, in the same order as on the graph*/
+template <size_t R, size_t C>
+void init_mat(grid_mesh<R, C>& mesh) {
+	srand(RANDOM_SEED > 0 ? RANDOM_SEED : time(0));
+	mesh_edges([&](vertex_d u, vertex_d v) { mesh.set_value(u, v, rand() % COST_GEN_RANGE + 1); });
 }
-
-vertex_d locate(Graph& sep_subtree, Graph& G, vertex_d p, edge_property_map& mvm, edge_property_map& Gvals) {
-	edge_t ei, ei_end;
-	vertex_d k;
-	vertex_d singleton = 0;
-	pair<vector<vertex_d>, int> cut;
-	vector<vertex_d> comp;
-	int min = INT_MAX;
-	char direction; /*This variable shows in which direction of the cut within the seperator tree lies our node k*/
-	vertex_d a = 0, b = 0, a_cand = 0, b_cand = 0; /*vertex a and b are the nodes that have the minimum cut within the seperator tree*/
-	int found = 0;
-	int check = 0;
-	int threshold = 0;
-	int attempts = 0; /*since we use an infinite loop we use the variable attempts to force exit the while loop in case of an undefined random state*/
-
-	while (1) {
-		if (p == 1) break; /*obviously if we are trying to add the second node within the seperator subtree then k should be the first node within the tree since it's a singleton*/
-		direction = 'n'; /*initialize the direction with 'nothing'*/
-
-		min = INT_MAX;
-		found = 0;
-		check = 0;
-		/*we locate the minimum a-b minimum cut candidates within this for*/
-		for (tie(ei, ei_end) = edges(sep_subtree); ei != ei_end; ei++) {
-			if (mvm[*ei] < min && mvm[*ei] >= threshold) {
-				if (source(*ei, sep_subtree) != a || target(*ei, sep_subtree) != b) {
-					min = mvm[*ei];
-					check = 1;
-					a_cand = source(*ei, sep_subtree);
-					b_cand = target(*ei, sep_subtree);
-				}
-			}
-		}
-		/*we update threshold to avoid falling into infinite loops but at the same time check every possible edge even if more than two edges have the same capacity*/
-		if (threshold == min) attempts++;
-		threshold = min;
-		if (attempts == 2) { /*if the program is stuck more than 2 times looking at the same edge then force it to move on by increasing threshold by one*/
-			attempts = 0;
-			threshold++;
-		}
-		a = a_cand;
-		b = b_cand;
-
-		cut = minimum_cut(a, b, Gvals, G); /*return the value of the minimum cut and the cut_set_A between nodes a and b*/
-		comp = comp_cut_set(cut.first, get_set_N(G)); /*find the complinent subset of cut_set_A*/
-
-		/*the rest of this code checks where k is within the a-b cut and repeats the while loop until it gets into a singleton set*/
-		for (int i = cut.first.size() - 1; i >= 0; i--) {
-			if (cut.first[i] == a) direction = 'a';
-			else if (cut.first[i] == b) direction = 'b';
-		}
-
-		for (int i = cut.first.size() - 1; i >= 0; i--) {
-			if (cut.first[i] == p) found = 1;
-		}
-		if (found == 1 && direction == 'a') {
-			if (cut.first.size() == 2) {
-				singleton = a;
-				break;
-			}
-
-		}
-		else if (found == 1 && direction == 'b') {
-			if (cut.first.size() == 2) {
-				singleton = b;
-				break;
-			}
-
-
-		}
-		else if (found == 0 && direction == 'a') {
-			if (out_degree(b, sep_subtree) == 1) {
-				singleton = b;
-				break;
-			}
-			if (check == 0) {
-				singleton = b;
-				break;
-			}
-
-
-		}
-		else if (found == 0 && direction == 'b') {
-			if (out_degree(a, sep_subtree) == 1) {
-				singleton = a;
-				break;
-			}
-			if (check == 0) {
-				singleton = a;
-				break;
-			}
-
-
-		}
-
-	}
-	k = singleton; /*k should now contain the correct singleton node*/
-	edge_d e = add_edge(p, k, sep_subtree).first; /*we link singleton node k with the node p that we were trying to add in our seperator tree*/
-	return k; /*we return the singleton node k*/
-}
\ No newline at end of file